@@ -2,6 +2,7 @@
 #define HTTP_H
 
 #include "utils/platform/platform.h"
+#include "utils/thread_pool/tread_pool.h"
 
 typedef struct HttpResponse HttpResponse;
 typedef struct HttpRequest HttpRequest;
@@ -12,10 +13,29 @@ typedef enum HttpMethod {
 
 typedef void (*RouteHandler)(const HttpRequest*, HttpResponse*);
 
+// 流式接收請求體：每收到一段 body 調用一次，返回非 0 拒絕該請求（回覆 400 並關閉連接）。
+// 請求在 handler 執行前終止時（連接斷開、被拒絕）會以 data == NULL 再調用一次，用於釋放狀態
+typedef int (*BodyChunkHandler)(HttpRequest* req, const char* data, size_t len);
+
+// route 可包含參數："/users/:id" 匹配一個路徑段，"/static/*path" 匹配餘下的全部路徑（可為空）。
+// 參數必須佔據整個路徑段，通配符只能在末尾；匹配時靜態段優先，其次參數，最後通配符
 void register_get_route(const char* route, RouteHandler handler);
 void register_put_route(const char* route, RouteHandler handler);
 void register_post_route(const char* route, RouteHandler handler);
 void register_delete_route(const char* route, RouteHandler handler);
+
+// body 不經緩衝，分段交給 on_chunk，全部收完後再調用 handler
+void register_post_stream_route(const char* route, BodyChunkHandler on_chunk, RouteHandler handler);
+void register_put_stream_route(const char* route, BodyChunkHandler on_chunk, RouteHandler handler);
+
+// 把 prefix 下的 GET 請求映射到 dir 中的文件，如 register_static_dir("/assets", "./public")。
+// 路徑中的 ".." 和以 '.' 開頭的隱藏文件或目錄（如 .git、.env）一律拒絕，以 '/' 結尾時發送 index.html；Content-Type 按擴展名推斷，
+// 文件經由緩存發送，支持條件請求、Range 和壓縮。目錄內的符號鏈接會被跟隨
+void register_static_dir(const char* prefix, const char* dir);
+
+// 路由可在服務器運行時註冊和刪除，進行中的請求不受影響。
+// route 須與註冊時完全相同（包括參數名），不存在時返回 -1
+int unregister_route(HttpMethod method, const char* route);
 void handle_client(NetSocket* s, NetSocket* client);
 
 typedef struct {
@@ -24,4 +44,39 @@ typedef struct {
 } ClientTaskArg;
 void* handle_client_task(void* arg);
 
+// 事件驅動的服務循環：非阻塞讀取，請求完整後才交給線程池處理；
+// pool 為 NULL 時直接在循環線程上處理請求
+void http_server_run(NetSocket* server, ThreadPool* pool);
+
+// 每個核心一個獨立的事件循環和監聽 socket（SO_REUSEPORT），連接不跨線程移交；
+// n_reactors <= 0 時按 CPU 數量啓動。阻塞直到所有循環退出
+void http_server_run_reuseport(const char* ip, uint16_t port, int n_reactors);
+
+// 長連接設置：每個連接最多處理 max_requests 個請求，空閒超過 idle_timeout_ms 毫秒後關閉
+void http_server_set_keep_alive(int max_requests, int idle_timeout_ms);
+
+// 請求頭須在 header_timeout_ms 內收齊；收取請求體或寫出響應時超過 body_timeout_ms / write_timeout_ms
+// 沒有任何進展則關閉連接。0 表示不限制
+void http_server_set_timeouts(int header_timeout_ms, int body_timeout_ms, int write_timeout_ms);
+
+// 每個連接待發送數據的高水位：超過後暫停讀取和處理該連接的新請求，直到隊列回落
+void http_server_set_write_high_water(size_t bytes);
+
+// 非流式路由緩衝請求體的上限，超過時回覆 413 並關閉連接
+void http_server_set_max_body_size(size_t bytes);
+
+// 請求頭的上限：請求行加所有頭部的總字節數，以及頭部行數；超過時回覆 431 並關閉連接
+void http_server_set_max_header_size(size_t bytes, size_t max_headers);
+
+// 文件響應的內存緩存：總共最多緩存 max_bytes 字節，單個文件超過 max_file_size 時直接發送文件。
+// 文件修改後自動失效。默認 32 MB / 512 KB，任一為 0 時不再緩存內容
+void http_server_set_file_cache(size_t max_bytes, size_t max_file_size);
+
+// 放不進內存緩存的文件保持打開，最多 max_handles 個，之後的請求不再 open / stat。默認 256，0 表示關閉
+void http_server_set_open_file_cache(size_t max_handles);
+
+// gzip 壓縮（需要以 CWEB_ZLIB 構建）：不小於 min_size 字節的文本 body 在客戶端接受時壓縮發送，
+// 緩存中的文件只壓縮一次。level 為 1-9，0 表示關閉。默認 1024 字節、級別 5
+void http_server_set_compression(size_t min_size, int level);
+
 #endif
@@ -4,11 +4,67 @@
 #include "http/http.h"
 #include <stddef.h>
 
+// 常用請求頭，解析時即建立索引
+typedef enum HttpHeaderId {
+    HTTP_HEADER_HOST,
+    HTTP_HEADER_CONNECTION,
+    HTTP_HEADER_CONTENT_LENGTH,
+    HTTP_HEADER_CONTENT_TYPE,
+    HTTP_HEADER_CONTENT_ENCODING,
+    HTTP_HEADER_TRANSFER_ENCODING,
+    HTTP_HEADER_EXPECT,
+    HTTP_HEADER_UPGRADE,
+    HTTP_HEADER_ACCEPT,
+    HTTP_HEADER_ACCEPT_ENCODING,
+    HTTP_HEADER_ACCEPT_LANGUAGE,
+    HTTP_HEADER_AUTHORIZATION,
+    HTTP_HEADER_COOKIE,
+    HTTP_HEADER_USER_AGENT,
+    HTTP_HEADER_REFERER,
+    HTTP_HEADER_ORIGIN,
+    HTTP_HEADER_CACHE_CONTROL,
+    HTTP_HEADER_RANGE,
+    HTTP_HEADER_IF_RANGE,
+    HTTP_HEADER_IF_MATCH,
+    HTTP_HEADER_IF_NONE_MATCH,
+    HTTP_HEADER_IF_MODIFIED_SINCE,
+    HTTP_HEADER_IF_UNMODIFIED_SINCE,
+    HTTP_HEADER_X_FORWARDED_FOR,
+    HTTP_HEADER_COUNT
+} HttpHeaderId;
+
 HttpMethod http_request_get_method(const HttpRequest *req);
+
+// 請求路徑：已去掉查詢字符串並解碼 %XX，路由按此匹配
 const char* http_request_get_route(const HttpRequest *req);
+
+// '?' 之後的原始查詢字符串（未解碼），沒有 '?' 時返回 NULL
+const char* http_request_get_query_string(const HttpRequest *req);
+
+// 查詢參數的值，已解碼 %XX 和 '+'；同名參數取第一個，不存在時返回 NULL。
+// 首次調用時才建立參數索引，每個值在第一次被查到時才解碼
+const char* http_request_get_query(const HttpRequest *req, const char* key);
+
+// 路由模式中 ":name" 或 "*name" 捕獲的值（已解碼），不存在時返回 NULL
+const char* http_request_get_param(const HttpRequest *req, const char* name);
+
+// 名稱大小寫不敏感；同名頭部出現多次時返回第一個
 const char* http_request_get_header(const HttpRequest *req, const char* key);
+
+// 按枚舉直接取常用頭部，不做字符串比較
+const char* http_request_get_known_header(const HttpRequest *req, HttpHeaderId id);
+
 const char* http_request_get_body(const HttpRequest *req, size_t* length);
 
+// 流式路由在收取 body 的各次回調和最終 handler 之間傳遞狀態
+void http_request_set_user_data(HttpRequest* req, void* data);
+void* http_request_get_user_data(const HttpRequest* req);
+
+// 從請求所屬的 arena 分配內存，按 max_align_t 對齊，內存不足時返回 NULL。
+// 無需釋放，在響應寫出後與請求一起回收，不能跨請求保存
+void* http_request_arena_alloc(const HttpRequest* req, size_t size);
+
+// 請求的內存隨響應寫出統一回收，此函數不再做任何事，保留以兼容舊代碼
 void free_request(HttpRequest* req);
 
 #endif
@@ -12,6 +12,18 @@ void http_response_set_json(HttpResponse* res, const char* json, ...);
 void http_response_add_header(HttpResponse* res, const char* key, const char* value);
 void http_response_set_file(HttpResponse* res, const char* filepath);
 
+// 流式響應（Transfer-Encoding: chunked）：handler 返回後，每當之前寫出的數據發送完畢，
+// 就調用一次 producer 生成下一部分；producer 每次應寫出一些數據（write_chunk）或調用 end 結束，
+// 暫時沒有數據時可以直接返回，約 HTTP_STREAM_RETRY_MS 後會再被調用（期間仍受寫超時限制）。
+// 流結束或連接中止後，producer 會以 res == NULL 再被調用一次，用於釋放 ctx
+#define HTTP_STREAM_RETRY_MS 100
+
+typedef void (*HttpStreamProducer)(HttpResponse* res, void* ctx);
+
+void http_response_begin_stream(HttpResponse* res, HttpStreamProducer producer, void* ctx);
+int http_response_write_chunk(HttpResponse* res, const void* data, size_t len);
+void http_response_end(HttpResponse* res);
+
 void free_response(HttpResponse* res);
 
 #endif
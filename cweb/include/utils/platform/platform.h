@@ -2,6 +2,7 @@
 #define PLATFORM_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <time.h>
 
 // ======== 網絡 ========
@@ -11,6 +12,13 @@ int net_init(void);
 void net_shutdown(void);
 
 NetSocket* net_tcp_listen(const char* ip, uint16_t port);
+
+// 允許多個 socket 綁定同一端口，由內核在它們之間分配新連接（SO_REUSEPORT）
+#define NET_LISTEN_REUSEPORT (1 << 0)
+
+// 平台不支持所請求的 flags 時返回 NULL
+NetSocket* net_tcp_listen_ex(const char* ip, uint16_t port, int flags);
+
 NetSocket* net_accept(NetSocket* server);
 
 int net_send(NetSocket* s, const void* buf, int len);
@@ -21,6 +29,44 @@ uint16_t net_get_port(NetSocket* s);
 
 void net_close(NetSocket* s);
 
+// 非阻塞 socket 上 net_send / net_recv 暫時無法完成時的返回值
+#define NET_WOULD_BLOCK (-2)
+
+int net_set_nonblocking(NetSocket* s, int enable);
+
+// 分散/聚集發送：一次系統調用寫出多段不連續的緩衝區
+typedef struct NetIoVec {
+    const void* base;
+    size_t len;
+} NetIoVec;
+
+#define NET_IOV_MAX 64
+
+// 返回實際發送的字節數，可能只寫出部分；超過 NET_IOV_MAX 的段留待下次發送
+int64_t net_sendv(NetSocket* s, const NetIoVec* iov, int count);
+
+// ======== 事件輪詢 ========
+typedef struct NetPoller NetPoller;
+
+enum {
+    NET_POLL_READ  = 1 << 0,
+    NET_POLL_WRITE = 1 << 1,
+    NET_POLL_ERROR = 1 << 2     // 僅輸出：連接出錯或對端關閉
+};
+
+typedef struct NetPollEvent {
+    void* udata;
+    int events;
+} NetPollEvent;
+
+NetPoller* net_poller_create(void);
+int net_poller_add(NetPoller* p, NetSocket* s, int events, void* udata);
+int net_poller_mod(NetPoller* p, NetSocket* s, int events, void* udata);
+int net_poller_del(NetPoller* p, NetSocket* s);
+int net_poller_wait(NetPoller* p, NetPollEvent* events, int max_events, int timeout_ms);
+void net_poller_wakeup(NetPoller* p);  // 可從其他綫程調用，令阻塞中的 wait 立即返回
+void net_poller_free(NetPoller* p);
+
 // ======== 綫程 ========
 typedef struct Thread Thread;
 typedef struct Mutex Mutex;
@@ -31,6 +77,8 @@ void thread_join(Thread* t);
 void thread_detach(Thread* t);
 void thread_free(Thread* t);
 void thread_sleep(long ms);
+int thread_set_affinity(Thread* t, int cpu);  // 綁定到指定 CPU，不支持時返回 -1
+int cpu_count(void);
 
 Mutex* mutex_create(void);
 void mutex_lock(Mutex* m);
@@ -46,7 +94,38 @@ void cond_free(Cond* c);
 // ======== I/O ========
 int mkdirectory(const char* path);
 
+typedef struct FileHandle FileHandle;
+
+// 只讀打開普通文件，size 輸出文件大小；目錄等非普通文件返回 NULL
+FileHandle* file_open_read(const char* path, uint64_t* size);
+void file_close(FileHandle* f);
+
+// 從 offset 處讀取最多 len 字節，返回讀到的字節數，0 表示已到文件末尾，出錯返回 -1
+int64_t file_read(FileHandle* f, void* buf, size_t len, uint64_t offset);
+
+// 普通文件的大小和修改時間（自 1970 年起的納秒）；不存在或不是普通文件時返回 -1
+int file_stat(const char* path, uint64_t* size, int64_t* mtime_ns);
+int file_fstat(FileHandle* f, uint64_t* size, int64_t* mtime_ns);  // 已打開文件的大小和修改時間
+
+// 監視文件的修改、刪除和移動。不支持的平台上 create 返回 NULL，調用方應改為按修改時間檢查
+typedef struct FileWatcher FileWatcher;
+
+FileWatcher* file_watcher_create(void);
+int file_watcher_add(FileWatcher* w, const char* path);    // 返回監視號，同一文件返回相同的號；失敗返回 -1
+void file_watcher_remove(FileWatcher* w, int id);
+// 等待文件變化，ids 輸出發生變化（或監視已失效）的監視號，返回個數；超時返回 0，出錯返回 -1。
+// 一次收到的事件超過 max 個時留到下次調用返回，不會丟棄；
+// 監視號 FILE_WATCH_OVERFLOW 表示系統的事件隊列溢出，任何監視中的文件都可能已經變化
+#define FILE_WATCH_OVERFLOW (-1)
+int file_watcher_wait(FileWatcher* w, int* ids, int max, int timeout_ms);
+void file_watcher_free(FileWatcher* w);
+
+// 把文件 [offset, offset + count) 的內容直接寫入 socket，不經過用戶態緩衝
+// 返回實際發送的字節數，可能少於 count；非阻塞時返回 NET_WOULD_BLOCK
+int64_t net_sendfile(NetSocket* s, FileHandle* f, uint64_t offset, size_t count);
+
 // ======== 時間 ========
 int localtime_safe(const time_t* t, struct tm* out_tm);
+uint64_t time_now_ms(void);  // 單調時鐘，毫秒
 
 #endif
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "http/http_arena_internal.h"
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGN alignof(max_align_t)
+
+struct HttpArenaBlock {
+    HttpArenaBlock* next;
+    size_t cap;
+    size_t used;
+    alignas(max_align_t) unsigned char data[];
+};
+
+static size_t align_up(size_t n) {
+    return (n + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+static HttpArenaBlock* block_new(size_t cap) {
+    HttpArenaBlock* b = malloc(sizeof(HttpArenaBlock) + cap);
+    if (!b) return NULL;
+    b->next = NULL;
+    b->cap = cap;
+    b->used = 0;
+    return b;
+}
+
+void http_arena_init(HttpArena* a) {
+    a->head = NULL;
+    a->keep = NULL;
+}
+
+void http_arena_free(HttpArena* a) {
+    HttpArenaBlock* b = a->head;
+    while (b) {
+        HttpArenaBlock* next = b->next;
+        free(b);
+        b = next;
+    }
+    http_arena_init(a);
+}
+
+void* http_arena_alloc(HttpArena* a, size_t size) {
+    HttpArenaBlock* b = a->head;
+    if (b) {
+        size_t off = align_up(b->used);
+        if (off <= b->cap && size <= b->cap - off) {
+            b->used = off + size;
+            return b->data + off;
+        }
+    }
+
+    // 大的分配獨佔一塊，掛在當前塊之後，不影響之後的小分配
+    if (size > HTTP_ARENA_BLOCK_SIZE / 2 && a->head) {
+        HttpArenaBlock* big = block_new(size);
+        if (!big) return NULL;
+        big->used = size;
+        big->next = a->head->next;
+        a->head->next = big;
+        return big->data;
+    }
+
+    b = block_new(size > HTTP_ARENA_BLOCK_SIZE ? size : HTTP_ARENA_BLOCK_SIZE);
+    if (!b) return NULL;
+    b->used = size;
+    b->next = a->head;
+    a->head = b;
+    if (!a->keep && b->cap == HTTP_ARENA_BLOCK_SIZE) a->keep = b;
+    return b->data;
+}
+
+void* http_arena_grow(HttpArena* a, void* ptr, size_t old_size, size_t new_size) {
+    if (!ptr) return http_arena_alloc(a, new_size);
+    if (new_size <= old_size) return ptr;
+
+    HttpArenaBlock* b = a->head;
+    if (b && (unsigned char*)ptr + old_size == b->data + b->used &&
+        new_size - old_size <= b->cap - b->used) {
+        b->used += new_size - old_size;
+        return ptr;
+    }
+
+    void* p = http_arena_alloc(a, new_size);
+    if (p) memcpy(p, ptr, old_size);
+    return p;
+}
+
+char* http_arena_strdup(HttpArena* a, const char* s) {
+    size_t n = strlen(s) + 1;
+    char* p = http_arena_alloc(a, n);
+    if (p) memcpy(p, s, n);
+    return p;
+}
+
+void http_arena_reset(HttpArena* a) {
+    HttpArenaBlock* b = a->head;
+    while (b) {
+        HttpArenaBlock* next = b->next;
+        if (b != a->keep) free(b);
+        b = next;
+    }
+    a->head = a->keep;
+    if (a->keep) {
+        a->keep->next = NULL;
+        a->keep->used = 0;
+    }
+}
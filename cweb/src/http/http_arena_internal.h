@@ -0,0 +1,31 @@
+#ifndef HTTP_ARENA_INTERNAL_H
+#define HTTP_ARENA_INTERNAL_H
+
+#include <stddef.h>
+
+#define HTTP_ARENA_BLOCK_SIZE (16 * 1024)  // 容得下一般請求和它的響應
+
+typedef struct HttpArenaBlock HttpArenaBlock;
+
+// 連接上請求和響應共用的線性分配器：分配只是移動指針，不單獨釋放，
+// 之前的響應都寫出後整體重置。只由持有連接的線程使用
+typedef struct HttpArena {
+    HttpArenaBlock* head;   // 當前分配的塊，之後鏈接更早的塊和獨佔的大塊
+    HttpArenaBlock* keep;   // 第一個標準大小的塊，重置時保留，供下一個請求復用
+} HttpArena;
+
+void http_arena_init(HttpArena* a);
+void http_arena_free(HttpArena* a);
+
+// 按 max_align_t 對齊，內存不足時返回 NULL
+void* http_arena_alloc(HttpArena* a, size_t size);
+
+// ptr 是最近一次分配且塊內還有空間時原地擴展，否則分配新空間並複製
+void* http_arena_grow(HttpArena* a, void* ptr, size_t old_size, size_t new_size);
+
+char* http_arena_strdup(HttpArena* a, const char* s);
+
+// 釋放除保留塊以外的所有塊，之前分配的內存全部失效
+void http_arena_reset(HttpArena* a);
+
+#endif
@@ -0,0 +1,125 @@
+#include "http/http_compress_internal.h"
+#include "http/http.h"
+
+#include <limits.h>
+#include <string.h>
+
+#ifdef CWEB_ZLIB
+#include <zlib.h>
+#endif
+
+static size_t g_min_size = HTTP_GZIP_DEFAULT_MIN_SIZE;
+static int g_level = HTTP_GZIP_DEFAULT_LEVEL;
+
+void http_server_set_compression(size_t min_size, int level) {
+    g_min_size = min_size;
+    g_level = level < 0 ? 0 : level > 9 ? 9 : level;
+}
+
+int http_gzip_enabled(void) {
+#ifdef CWEB_ZLIB
+    return g_level > 0;
+#else
+    return 0;
+#endif
+}
+
+size_t http_gzip_min_size(void) {
+    return g_min_size;
+}
+
+size_t http_gzip(const void* in, size_t len, void* out, size_t cap) {
+#ifdef CWEB_ZLIB
+    // 每個綫程復用一個壓縮流，避免每次分配 zlib 的內部狀態
+    static _Thread_local z_stream t_zs;
+    static _Thread_local int t_level;
+
+    if (len > UINT_MAX || g_level <= 0) return 0;
+    if (cap > len) cap = len;
+    if (cap > UINT_MAX) cap = UINT_MAX;
+
+    if (t_level != g_level) {
+        if (t_level) deflateEnd(&t_zs);
+        memset(&t_zs, 0, sizeof(t_zs));
+        // windowBits 加 16 輸出 gzip 頭和尾
+        if (deflateInit2(&t_zs, g_level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            t_level = 0;
+            return 0;
+        }
+        t_level = g_level;
+    } else if (deflateReset(&t_zs) != Z_OK) {
+        return 0;
+    }
+
+    t_zs.next_in = (Bytef*)in;
+    t_zs.avail_in = (uInt)len;
+    t_zs.next_out = (Bytef*)out;
+    t_zs.avail_out = (uInt)cap;
+    // 輸出空間只有原數據大小，放不下說明不值得壓縮
+    if (deflate(&t_zs, Z_FINISH) != Z_STREAM_END || t_zs.total_out >= len) return 0;
+    return (size_t)t_zs.total_out;
+#else
+    (void)in;
+    (void)len;
+    (void)out;
+    (void)cap;
+    return 0;
+#endif
+}
+
+int http_compressible_type(const char* type) {
+    if (!type) return 0;
+    if (strncmp(type, "text/", 5) == 0) return 1;
+
+    size_t len = strcspn(type, ";");
+    static const char* const kinds[] = { "json", "javascript", "xml", "svg" };
+    for (size_t i = 0; i < sizeof(kinds) / sizeof(kinds[0]); i++) {
+        size_t k = strlen(kinds[i]);
+        for (size_t j = 0; j + k <= len; j++) {
+            if (memcmp(type + j, kinds[i], k) == 0) return 1;
+        }
+    }
+    return 0;
+}
+
+static int token_eq(const char* tok, size_t len, const char* name) {
+    for (size_t i = 0; i < len; i++) {
+        if (!name[i] || (tok[i] | 0x20) != (name[i] | 0x20)) return 0;
+    }
+    return name[len] == '\0';
+}
+
+// "0"、"0."、"0.000" 都表示不接受
+static int q_is_zero(const char* q) {
+    if (*q++ != '0') return 0;
+    if (*q == '.') {
+        q++;
+        while (*q == '0') q++;
+    }
+    return *q == '\0' || *q == ',' || *q == ';' || *q == ' ' || *q == '\t';
+}
+
+int http_accepts_encoding(const char* accept_encoding, const char* coding) {
+    if (!accept_encoding || !coding) return 0;
+
+    int star = 0;
+    const char* p = accept_encoding;
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        const char* tok = p;
+        while (*p && *p != ',' && *p != ';' && *p != ' ' && *p != '\t') p++;
+        size_t tok_len = (size_t)(p - tok);
+
+        // 參數中只關心 q
+        int zero = 0;
+        while (*p && *p != ',') {
+            if (*p++ != ';') continue;
+            while (*p == ' ' || *p == '\t') p++;
+            if ((*p == 'q' || *p == 'Q') && p[1] == '=') zero = q_is_zero(p + 2);
+        }
+
+        if (tok_len > 0 && token_eq(tok, tok_len, coding)) return !zero;
+        if (tok_len == 1 && *tok == '*') star = !zero;
+    }
+    return star;
+}
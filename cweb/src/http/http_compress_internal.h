@@ -0,0 +1,24 @@
+#ifndef HTTP_COMPRESS_INTERNAL_H
+#define HTTP_COMPRESS_INTERNAL_H
+
+#include <stddef.h>
+
+#define HTTP_GZIP_DEFAULT_MIN_SIZE 1024
+#define HTTP_GZIP_DEFAULT_LEVEL 5
+
+// 以 CWEB_ZLIB 構建且壓縮級別大於 0 時返回 1
+int http_gzip_enabled(void);
+
+// 小於此大小的 body 不壓縮
+size_t http_gzip_min_size(void);
+
+// 以 gzip 格式壓縮到 out，最多寫入 cap 字節；結果不比原數據小、空間不足或出錯時返回 0
+size_t http_gzip(const void* in, size_t len, void* out, size_t cap);
+
+// 值得壓縮的 Content-Type：text/*、JSON、JavaScript、XML 和 SVG
+int http_compressible_type(const char* type);
+
+// Accept-Encoding 中 coding（或 "*"）的 q 值大於 0 時返回 1
+int http_accepts_encoding(const char* accept_encoding, const char* coding);
+
+#endif
@@ -0,0 +1,510 @@
+#include "http/http_file_cache_internal.h"
+#include "http/http.h"
+#include "http/http_compress_internal.h"
+#include "http/http_response_internal.h"
+
+#include "utils/log/logger.h"
+#include "utils/platform/platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 文件內容按路徑分片緩存，每個分片有自己的鎖、哈希表、LRU 鏈表和字節預算。
+// 有文件監視時由後台綫程在文件變化後移除條目，命中時不需要任何系統調用；
+// 否則（或監視建立過程中文件發生了變化）命中時至多每 HTTP_FILE_CACHE_CHECK_MS 檢查一次修改時間
+
+typedef struct CacheShard {
+    Mutex* lock;
+    HttpCachedFile** buckets;
+    size_t bucket_count;
+    size_t count;
+    size_t bytes;
+    size_t handles;             // 只緩存句柄的條目數
+    HttpCachedFile* lru_head;   // 最近使用
+    HttpCachedFile* lru_tail;
+    HttpCachedFile* miss_head;  // 不存在的記錄單獨排隊，隨意請求不存在的路徑不會擠掉熱點文件
+    HttpCachedFile* miss_tail;
+    size_t misses;
+} CacheShard;
+
+enum { CACHE_UNINIT, CACHE_INITIALIZING, CACHE_READY, CACHE_FAILED };
+
+static size_t g_max_bytes = HTTP_FILE_CACHE_DEFAULT_BYTES;
+static size_t g_max_file_size = HTTP_FILE_CACHE_DEFAULT_FILE_SIZE;
+static size_t g_max_handles = HTTP_FILE_CACHE_DEFAULT_HANDLES;
+
+static CacheShard g_shards[HTTP_FILE_CACHE_SHARDS];
+static atomic_int g_state = CACHE_UNINIT;
+
+static FileWatcher* g_watcher;
+static atomic_int g_watching;       // 監視綫程正常運行
+static atomic_uint g_watch_events;  // 監視綫程每處理一批事件加一
+
+static HttpCachedGzip g_gzip_useless;  // 壓縮不能減小體積的標記
+
+void http_server_set_file_cache(size_t max_bytes, size_t max_file_size) {
+    g_max_bytes = max_bytes;
+    g_max_file_size = max_file_size;
+}
+
+void http_server_set_open_file_cache(size_t max_handles) {
+    g_max_handles = max_handles;
+}
+
+void http_file_validators(uint64_t size, int64_t mtime_ns, HttpFileValidators* out) {
+    // 同 nginx："修改時間-大小"，這裡的修改時間精確到納秒
+    snprintf(out->etag, sizeof(out->etag), "\"%llx-%llx\"",
+             (unsigned long long)mtime_ns, (unsigned long long)size);
+    int64_t secs = mtime_ns / 1000000000;
+    if (mtime_ns < 0 && secs * 1000000000 != mtime_ns) secs--;
+    out->mtime = (time_t)secs;
+    http_format_date(out->mtime, out->last_modified);
+}
+
+// ======== 條目 ========
+// 條目、路徑和內容在同一塊內存中，壓縮結果單獨分配
+static size_t entry_cost(const HttpCachedFile* f) {
+    const HttpCachedGzip* gz = atomic_load_explicit(&f->gzip, memory_order_acquire);
+    return sizeof(HttpCachedFile) + strlen(f->path) + 1 + (f->data ? (size_t)f->size : 0) +
+           (gz ? gz->size : 0);
+}
+
+static void entry_release(HttpCachedFile* f) {
+    if (atomic_fetch_sub_explicit(&f->refs, 1, memory_order_acq_rel) == 1) {
+        HttpCachedGzip* gz = atomic_load_explicit(&f->gzip, memory_order_acquire);
+        if (gz != &g_gzip_useless) free(gz);
+        file_close(f->file);
+        free(f);
+    }
+}
+
+void http_file_cache_release(const HttpCachedFile* f) {
+    if (f) entry_release((HttpCachedFile*)f);
+}
+
+static uint64_t hash_path(const char* path) {
+    uint64_t h = 14695981039346656037ULL;     // FNV-1a
+    for (const unsigned char* p = (const unsigned char*)path; *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// ======== 分片 ========
+// 以下函數的調用方持有分片的鎖
+static size_t bucket_of(const CacheShard* s, uint64_t hash) {
+    // 低位已用於選擇分片
+    return (size_t)(hash / HTTP_FILE_CACHE_SHARDS) & (s->bucket_count - 1);
+}
+
+static HttpCachedFile* shard_find(CacheShard* s, const char* path, uint64_t hash) {
+    if (s->bucket_count == 0) return NULL;
+    for (HttpCachedFile* f = s->buckets[bucket_of(s, hash)]; f; f = f->hash_next) {
+        if (f->hash == hash && strcmp(f->path, path) == 0) return f;
+    }
+    return NULL;
+}
+
+static int shard_grow(CacheShard* s) {
+    size_t n = s->bucket_count ? s->bucket_count * 2 : 16;
+    HttpCachedFile** buckets = calloc(n, sizeof(HttpCachedFile*));
+    if (!buckets) return -1;
+
+    size_t old_count = s->bucket_count;
+    HttpCachedFile** old = s->buckets;
+    s->buckets = buckets;
+    s->bucket_count = n;
+    for (size_t i = 0; i < old_count; i++) {
+        HttpCachedFile* f = old[i];
+        while (f) {
+            HttpCachedFile* next = f->hash_next;
+            size_t b = bucket_of(s, f->hash);
+            f->hash_next = buckets[b];
+            buckets[b] = f;
+            f = next;
+        }
+    }
+    free(old);
+    return 0;
+}
+
+// 不存在的記錄和文件條目各在自己的鏈表中
+static void lru_unlink(CacheShard* s, HttpCachedFile* f) {
+    HttpCachedFile** head = f->missing ? &s->miss_head : &s->lru_head;
+    HttpCachedFile** tail = f->missing ? &s->miss_tail : &s->lru_tail;
+    if (f->lru_prev) f->lru_prev->lru_next = f->lru_next;
+    else *head = f->lru_next;
+    if (f->lru_next) f->lru_next->lru_prev = f->lru_prev;
+    else *tail = f->lru_prev;
+    f->lru_prev = f->lru_next = NULL;
+}
+
+static void lru_push_front(CacheShard* s, HttpCachedFile* f) {
+    HttpCachedFile** head = f->missing ? &s->miss_head : &s->lru_head;
+    HttpCachedFile** tail = f->missing ? &s->miss_tail : &s->lru_tail;
+    f->lru_prev = NULL;
+    f->lru_next = *head;
+    if (*head) (*head)->lru_prev = f;
+    else *tail = f;
+    *head = f;
+}
+
+// 移出緩存並釋放緩存持有的引用；正在發送的響應仍持有自己的引用
+static void shard_remove(CacheShard* s, HttpCachedFile* f) {
+    HttpCachedFile** pp = &s->buckets[bucket_of(s, f->hash)];
+    while (*pp != f) pp = &(*pp)->hash_next;
+    *pp = f->hash_next;
+    lru_unlink(s, f);
+    s->count--;
+    if (f->missing) s->misses--;
+    else s->bytes -= entry_cost(f);
+    if (f->file) s->handles--;
+    f->linked = 0;
+    entry_release(f);
+}
+
+// 因容量淘汰時不再需要監視該文件；共用同一監視號的其他條目會因此失效，之後重新讀入
+static void shard_evict(CacheShard* s, HttpCachedFile* f) {
+    if (f->wd >= 0 && g_watcher) file_watcher_remove(g_watcher, f->wd);
+    shard_remove(s, f);
+}
+
+// ======== 文件監視 ========
+// 事件隊列溢出時所有監視中的條目都可能已經過期
+static int has_id(const int* ids, int n, int wd) {
+    for (int i = 0; i < n; i++) {
+        if (ids[i] == wd || ids[i] == FILE_WATCH_OVERFLOW) return 1;
+    }
+    return 0;
+}
+
+static void watch_loop(void* arg) {
+    (void)arg;
+    int ids[64];
+    for (;;) {
+        int n = file_watcher_wait(g_watcher, ids, 64, -1);
+        if (n < 0) break;
+        if (n == 0) continue;
+
+        // 先計數再移除：正在讀入的條目看到計數變化後不會被當作監視中
+        atomic_fetch_add_explicit(&g_watch_events, 1, memory_order_acq_rel);
+        for (int i = 0; i < HTTP_FILE_CACHE_SHARDS; i++) {
+            CacheShard* s = &g_shards[i];
+            mutex_lock(s->lock);
+            HttpCachedFile* f = s->lru_head;
+            while (f) {
+                HttpCachedFile* next = f->lru_next;
+                if (f->wd >= 0 && has_id(ids, n, f->wd)) shard_remove(s, f);
+                f = next;
+            }
+            mutex_unlock(s->lock);
+        }
+    }
+
+    // 之後所有條目改為按修改時間檢查
+    atomic_store_explicit(&g_watching, 0, memory_order_release);
+    LOG_WARN("file cache watcher stopped, falling back to mtime checks");
+}
+
+static void cache_init(void) {
+    for (int i = 0; i < HTTP_FILE_CACHE_SHARDS; i++) {
+        g_shards[i].lock = mutex_create();
+        if (!g_shards[i].lock) {
+            atomic_store_explicit(&g_state, CACHE_FAILED, memory_order_release);
+            return;
+        }
+    }
+
+    g_watcher = file_watcher_create();
+    if (g_watcher) {
+        atomic_store_explicit(&g_watching, 1, memory_order_relaxed);
+        Thread* t = thread_create(watch_loop, NULL);
+        if (t) {
+            thread_detach(t);
+            thread_free(t);
+        } else {
+            atomic_store_explicit(&g_watching, 0, memory_order_relaxed);
+        }
+    }
+    atomic_store_explicit(&g_state, CACHE_READY, memory_order_release);
+}
+
+static int cache_ready(void) {
+    int state = atomic_load_explicit(&g_state, memory_order_acquire);
+    if (state == CACHE_READY) return 1;
+
+    int expected = CACHE_UNINIT;
+    if (state == CACHE_UNINIT &&
+        atomic_compare_exchange_strong_explicit(&g_state, &expected, CACHE_INITIALIZING,
+                                                memory_order_acq_rel, memory_order_acquire)) {
+        cache_init();
+    } else {
+        while ((state = atomic_load_explicit(&g_state, memory_order_acquire)) == CACHE_INITIALIZING)
+            thread_sleep(1);
+    }
+    return atomic_load_explicit(&g_state, memory_order_acquire) == CACHE_READY;
+}
+
+// ======== 查找和讀入 ========
+// 句柄條目也佔少量內存，內容緩存關閉時仍給它們留出空間
+static size_t shard_budget(void) {
+    size_t budget = g_max_bytes / HTTP_FILE_CACHE_SHARDS;
+    return budget > HTTP_FILE_CACHE_MIN_SHARD_BYTES ? budget : HTTP_FILE_CACHE_MIN_SHARD_BYTES;
+}
+
+// data_size 為 0 時不帶內容
+static HttpCachedFile* entry_new(const char* path, uint64_t hash, uint64_t data_size) {
+    size_t path_len = strlen(path);
+    HttpCachedFile* f = malloc(sizeof(HttpCachedFile) + path_len + 1 + (size_t)data_size);
+    if (!f) return NULL;
+    memset(f, 0, sizeof(HttpCachedFile));
+
+    char* path_copy = (char*)(f + 1);
+    memcpy(path_copy, path, path_len + 1);
+    f->path = path_copy;
+    f->data = data_size ? (unsigned char*)path_copy + path_len + 1 : NULL;
+    f->size = data_size;
+    f->hash = hash;
+    f->wd = -1;
+    atomic_init(&f->refs, 2);   // 緩存和調用方各一個
+    atomic_init(&f->gzip, NULL);
+    return f;
+}
+
+static size_t shard_max_handles(void) {
+    return (g_max_handles + HTTP_FILE_CACHE_SHARDS - 1) / HTTP_FILE_CACHE_SHARDS;
+}
+
+// 打開文件，以 fstat 的結果為準：能放入緩存的讀入內容，否則只保留句柄
+static HttpCachedFile* load_file(const char* path, uint64_t hash, int wd) {
+    uint64_t size;
+    int64_t mtime;
+    FileHandle* fh = file_open_read(path, &size);
+    if (!fh || file_fstat(fh, &size, &mtime) != 0) {
+        file_close(fh);
+        return NULL;
+    }
+
+    int keep_handle = !http_file_cache_fits(size);
+    if (keep_handle && g_max_handles == 0) {
+        file_close(fh);
+        return NULL;
+    }
+
+    HttpCachedFile* f = entry_new(path, hash, keep_handle ? 0 : size);
+    if (!f) {
+        file_close(fh);
+        return NULL;
+    }
+    f->size = size;
+
+    if (keep_handle) {
+        f->file = fh;
+    } else {
+        unsigned char* data = (unsigned char*)f->data;
+        uint64_t done = 0;
+        while (done < size) {
+            int64_t n = file_read(fh, data + done, (size_t)(size - done), done);
+            if (n <= 0) break;
+            done += (uint64_t)n;
+        }
+        file_close(fh);
+        if (done != size) {
+            // 讀取期間文件被截斷
+            free(f);
+            return NULL;
+        }
+    }
+
+    f->mtime_ns = mtime;
+    http_file_validators(size, mtime, &f->validators);
+    f->wd = wd;
+    return f;
+}
+
+static void shard_insert(CacheShard* s, HttpCachedFile* f) {
+    size_t cost = entry_cost(f);
+    HttpCachedFile* old = shard_find(s, f->path, f->hash);
+    if (old) shard_remove(s, old);
+
+    if (f->missing) {
+        while (s->miss_tail && s->misses >= HTTP_FILE_CACHE_SHARD_MISSES) shard_remove(s, s->miss_tail);
+    } else {
+        while (s->lru_tail && s->bytes + cost > shard_budget()) shard_evict(s, s->lru_tail);
+    }
+    if (f->file) {
+        // 句柄數到上限時淘汰最久未用的句柄條目
+        HttpCachedFile* victim = s->lru_tail;
+        while (victim && s->handles >= shard_max_handles()) {
+            HttpCachedFile* prev = victim->lru_prev;
+            if (victim->file) shard_evict(s, victim);
+            victim = prev;
+        }
+    }
+    if (s->count >= s->bucket_count && shard_grow(s) != 0) {
+        entry_release(f);   // 只留下調用方的引用，不緩存
+        return;
+    }
+
+    size_t b = bucket_of(s, f->hash);
+    f->hash_next = s->buckets[b];
+    s->buckets[b] = f;
+    lru_push_front(s, f);
+    s->count++;
+    if (f->missing) s->misses++;
+    else s->bytes += cost;
+    if (f->file) s->handles++;
+    f->linked = 1;
+}
+
+// 未確認監視的條目：重新建立監視並對比修改時間，未變化時轉為監視中；已變化返回 -1
+static int shard_revalidate(HttpCachedFile* f, uint64_t now) {
+    if (f->missing) {
+        if (file_stat(f->path, NULL, NULL) == 0) return -1;
+        f->checked_ms = now;
+        return 0;
+    }
+
+    int wd = atomic_load_explicit(&g_watching, memory_order_acquire)
+                 ? file_watcher_add(g_watcher, f->path) : -1;
+
+    uint64_t size;
+    int64_t mtime;
+    if (file_stat(f->path, &size, &mtime) != 0 || size != f->size || mtime != f->mtime_ns) return -1;
+
+    // 條目已在表中，監視號設好後的事件都會使它失效
+    f->watched = wd >= 0 && wd == f->wd;
+    f->wd = wd;
+    f->checked_ms = now;
+    return 0;
+}
+
+static int cache_enabled(void) {
+    return (g_max_bytes != 0 || g_max_handles != 0) && cache_ready();
+}
+
+static HttpCachedFile* cache_lookup(CacheShard* s, const char* path, uint64_t hash) {
+    mutex_lock(s->lock);
+    HttpCachedFile* f = shard_find(s, path, hash);
+    if (f && !(f->watched && atomic_load_explicit(&g_watching, memory_order_relaxed))) {
+        uint64_t now = time_now_ms();
+        if (now - f->checked_ms >= HTTP_FILE_CACHE_CHECK_MS && shard_revalidate(f, now) != 0) {
+            shard_remove(s, f);
+            f = NULL;
+        }
+    }
+    if (f) {
+        if (f->lru_prev) {
+            lru_unlink(s, f);
+            lru_push_front(s, f);
+        }
+        atomic_fetch_add_explicit(&f->refs, 1, memory_order_relaxed);
+    }
+    mutex_unlock(s->lock);
+    return f;
+}
+
+// 記錄為不存在的條目不返回給調用方
+static HttpCachedFile* check_missing(HttpCachedFile* f, int* missing) {
+    if (missing) *missing = f && f->missing;
+    if (f && f->missing) {
+        entry_release(f);
+        return NULL;
+    }
+    return f;
+}
+
+// 插入不存在的記錄，調用方只得到 missing 標記
+static void remember_missing(CacheShard* s, const char* path, uint64_t hash) {
+    HttpCachedFile* f = entry_new(path, hash, 0);
+    if (!f) return;
+    f->missing = 1;
+    f->checked_ms = time_now_ms();
+    atomic_init(&f->refs, 1);
+
+    mutex_lock(s->lock);
+    shard_insert(s, f);
+    mutex_unlock(s->lock);
+}
+
+int http_file_cache_fits(uint64_t size) {
+    return g_max_bytes != 0 && g_max_file_size != 0 && size <= g_max_file_size &&
+           size < g_max_bytes / HTTP_FILE_CACHE_SHARDS;
+}
+
+const HttpCachedFile* http_file_cache_get(const char* path, int* missing) {
+    if (missing) *missing = 0;
+    if (!path || !cache_enabled()) return NULL;
+
+    uint64_t hash = hash_path(path);
+    CacheShard* s = &g_shards[hash % HTTP_FILE_CACHE_SHARDS];
+    HttpCachedFile* f = cache_lookup(s, path, hash);
+    if (f) return check_missing(f, missing);
+
+    // 未命中：先看大小，既不能讀入也不能保留句柄的文件不建立監視
+    uint64_t size;
+    if (file_stat(path, &size, NULL) != 0) {
+        // 主文件不存在時調用方總要再打開一次才能回覆 404，記錄下來沒有用處
+        if (missing) {
+            remember_missing(s, path, hash);
+            *missing = 1;
+        }
+        return NULL;
+    }
+    if (!http_file_cache_fits(size) && g_max_handles == 0) return NULL;
+
+    // 監視要在讀取內容之前建立，才不會錯過讀取之後的修改
+    unsigned events = atomic_load_explicit(&g_watch_events, memory_order_acquire);
+    int wd = atomic_load_explicit(&g_watching, memory_order_acquire)
+                 ? file_watcher_add(g_watcher, path) : -1;
+
+    f = load_file(path, hash, wd);
+    if (!f) return NULL;
+    f->checked_ms = time_now_ms();
+
+    mutex_lock(s->lock);
+    // 從建立監視到現在處理過任何事件，就不能確定這個文件的事件沒有被錯過；
+    // 在鎖內判斷，之後的事件處理一定能在表中找到它
+    f->watched = wd >= 0 && atomic_load_explicit(&g_watch_events, memory_order_acquire) == events;
+    shard_insert(s, f);
+    mutex_unlock(s->lock);
+    return f;
+}
+
+const HttpCachedGzip* http_file_cache_gzip(const HttpCachedFile* cf) {
+    HttpCachedFile* f = (HttpCachedFile*)cf;
+    if (!f->data) return NULL;
+    HttpCachedGzip* gz = atomic_load_explicit(&f->gzip, memory_order_acquire);
+    if (gz) return gz == &g_gzip_useless ? NULL : gz;
+
+    // 多個綫程可能同時壓縮，只保留先完成的結果
+    HttpCachedGzip* made = malloc(sizeof(HttpCachedGzip) + (size_t)f->size);
+    size_t n = made ? http_gzip(f->data, (size_t)f->size, made->data, (size_t)f->size) : 0;
+    if (n == 0) {
+        free(made);
+        made = &g_gzip_useless;
+    } else {
+        made->size = n;
+        HttpCachedGzip* shrunk = realloc(made, sizeof(HttpCachedGzip) + n);
+        if (shrunk) made = shrunk;
+    }
+
+    CacheShard* s = &g_shards[f->hash % HTTP_FILE_CACHE_SHARDS];
+    mutex_lock(s->lock);
+    HttpCachedGzip* expected = NULL;
+    if (atomic_compare_exchange_strong_explicit(&f->gzip, &expected, made,
+                                                memory_order_acq_rel, memory_order_acquire)) {
+        // 已被移出緩存的條目不再計入分片的用量
+        if (f->linked && made != &g_gzip_useless) {
+            s->bytes += made->size;
+            while (s->lru_tail && s->lru_tail != f && s->bytes > shard_budget()) shard_evict(s, s->lru_tail);
+        }
+    } else {
+        if (made != &g_gzip_useless) free(made);
+        made = expected;
+    }
+    mutex_unlock(s->lock);
+    return made == &g_gzip_useless ? NULL : made;
+}
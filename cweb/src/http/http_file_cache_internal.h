@@ -0,0 +1,74 @@
+#ifndef HTTP_FILE_CACHE_INTERNAL_H
+#define HTTP_FILE_CACHE_INTERNAL_H
+
+#include "utils/platform/platform.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#define HTTP_FILE_CACHE_SHARDS 16
+#define HTTP_FILE_CACHE_DEFAULT_BYTES (32 * 1024 * 1024)
+#define HTTP_FILE_CACHE_DEFAULT_FILE_SIZE (512 * 1024)
+#define HTTP_FILE_CACHE_DEFAULT_HANDLES 256    // 放不進內存緩存的大文件最多保持打開的句柄數
+#define HTTP_FILE_CACHE_MIN_SHARD_BYTES (64 * 1024)
+#define HTTP_FILE_CACHE_SHARD_MISSES 64  // 每個分片最多記錄的不存在路徑，與文件條目分開淘汰
+#define HTTP_FILE_CACHE_CHECK_MS 1000   // 沒有文件監視時，兩次檢查修改時間的最小間隔
+
+#define HTTP_ETAG_MAX 40
+
+// 文件響應的 ETag 和 Last-Modified，按文件大小和修改時間預先格式化
+typedef struct HttpFileValidators {
+    char etag[HTTP_ETAG_MAX];   // 強校驗器，含引號
+    char last_modified[32];     // IMF-fixdate
+    time_t mtime;               // 修改時間，精確到秒
+} HttpFileValidators;
+
+void http_file_validators(uint64_t size, int64_t mtime_ns, HttpFileValidators* out);
+
+// 緩存的文件按 gzip 壓縮後的內容，每個條目至多壓縮一次
+typedef struct HttpCachedGzip {
+    size_t size;                // 0 表示壓縮不能減小體積
+    unsigned char data[];
+} HttpCachedGzip;
+
+// 緩存中的文件內容，命中後直接作為響應 body 發送；大文件只緩存打開的句柄，由 sendfile 按偏移發送。
+// 內容在持有引用期間不變；文件被修改後舊的條目移出緩存，最後一個引用釋放時回收
+typedef struct HttpCachedFile {
+    const char* path;
+    const unsigned char* data;  // 只緩存句柄時為 NULL
+    FileHandle* file;           // 大文件打開的句柄，與持有引用的響應共用，不能單獨關閉
+    uint64_t size;
+    int64_t mtime_ns;           // 打開時 fstat 得到的修改時間
+    HttpFileValidators validators;
+    uint64_t hash;
+    atomic_int refs;            // 緩存本身持有一個引用
+    _Atomic(HttpCachedGzip*) gzip;
+
+    // 以下由所屬分片的鎖保護
+    int wd;                     // 文件監視號，沒有時為 -1
+    int watched;                // 確認不會錯過文件的變化，命中時無需檢查修改時間
+    int missing;                // 記錄文件不存在，按修改時間的間隔重新檢查
+    int linked;                 // 仍在緩存中
+    uint64_t checked_ms;
+    struct HttpCachedFile* hash_next;
+    struct HttpCachedFile* lru_prev;
+    struct HttpCachedFile* lru_next;
+} HttpCachedFile;
+
+// 返回 path 的緩存內容或打開的句柄並增加引用，未緩存時讀入或打開。文件不存在、緩存已關閉
+// 或大文件的句柄緩存已關閉時返回 NULL，調用方應改為直接發送文件；其中文件不存在時 missing 置 1。
+// 只有傳入 missing 的查找（旁路文件的探測）才記錄不存在的路徑，記錄數有單獨的上限，不佔文件條目的預算。
+// 監視中的熱點文件命中時不做任何文件系統調用
+const HttpCachedFile* http_file_cache_get(const char* path, int* missing);
+
+void http_file_cache_release(const HttpCachedFile* f);
+
+// size 字節的文件能否把內容放入緩存
+int http_file_cache_fits(uint64_t size);
+
+// 條目內容的 gzip 壓縮結果，第一次調用時壓縮並與條目一起保存；壓縮不能減小體積或失敗時返回 NULL
+const HttpCachedGzip* http_file_cache_gzip(const HttpCachedFile* f);
+
+#endif
@@ -4,16 +4,24 @@
 #include <stdint.h>
 #include <stddef.h>
 
-#define MAX_HEADER_SIZE 32
+#define HTTP_RESPONSE_HEADERS_INIT 8   // 響應頭數組的初始容量，不夠時在 arena 中加倍
 
+#define HTTP_MAX_HEADER_BYTES (8 * 1024)   // 響應頭序列化緩衝區；請求頭的默認上限
+#define HTTP_DEFAULT_MAX_HEADERS 100
+#define HTTP_DEFAULT_MAX_BODY_SIZE (1024 * 1024)
+#define HTTP_METHOD_COUNT 4               // HttpMethod 的取值個數
+
+// 名稱和值都是複製到響應 arena 中的字符串
 typedef struct HttpHeader {
-    char key[64];
-    char value[256];
+    const char* key;
+    const char* value;
 } HttpHeader;
 
+// 響應頭按添加順序存放，數組在 arena 中按需增長，沒有頭部時不佔用內存
 typedef struct {
-    HttpHeader items[MAX_HEADER_SIZE];
+    HttpHeader* items;
     size_t count;
+    size_t cap;
 } HeaderTable;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,576 @@
+#include "http/http.h"
+#include "http/http_internal.h"
+#include "http/http_reader_internal.h"
+#include "http/http_timer_internal.h"
+#include "http/http_writer_internal.h"
+
+#include "utils/log/logger.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOOP_MAX_EVENTS 256
+#define LOOP_WAIT_MS    1000           // 沒有定時器時 poll 的最長等待
+#define LOOP_TIMER_TICK_MS 100         // 超時的精度
+#define CONN_READ_CHUNK 4096
+#define CONN_FLUSH_BYTES (64 * 1024)   // 管線化響應累積到該大小時先寫出一次
+#define CONN_MAX_BUFFER  (64 * 1024)   // 接收緩衝區滿後暫停讀取，等待請求被處理
+
+typedef struct HttpLoopConfig {
+    int max_requests;
+    int idle_timeout_ms;
+    int header_timeout_ms;
+    int body_timeout_ms;
+    int write_timeout_ms;
+    size_t write_high_water;
+} HttpLoopConfig;
+
+static HttpLoopConfig g_config = {
+    100,            // max_requests
+    5000,           // idle_timeout_ms
+    10000,          // header_timeout_ms
+    10000,          // body_timeout_ms
+    10000,          // write_timeout_ms
+    1024 * 1024     // write_high_water
+};
+
+// 連接在事件循環中等待的內容，決定適用哪一種超時
+typedef enum ConnPhase {
+    CONN_IDLE,      // 等待下一個請求：空閒超時
+    CONN_HEADER,    // 請求頭未收齊：從收到第一個字節起計算
+    CONN_BODY,      // 請求體未收齊：兩次收到數據之間的間隔
+    CONN_WRITE      // 響應未寫完：兩次寫出進展之間的間隔
+} ConnPhase;
+
+struct HttpLoop;
+
+typedef struct HttpConnection {
+    NetSocket* sock;
+    struct HttpLoop* loop;
+
+    char* buf;
+    size_t len;
+    size_t cap;
+
+    HttpReader reader;      // 正在讀取的請求
+    HttpWriter writer;      // 按請求順序排隊的待發送響應
+
+    int requests;           // 已處理的請求數
+    int keep_alive;         // 是否還會繼續處理後續請求
+    int peer_closed;        // 對端已關閉寫方向
+    int broken;             // 寫出失敗，應立即關閉
+    int need_more;          // 緩衝區中的數據已處理完，等待新數據
+    int watched;            // 是否由事件循環持有
+    int stream_idle;        // 流式響應的 producer 上次沒有生成數據，等定時器再調用
+    int events;             // 當前註冊的事件
+    uint64_t last_active;   // 最近一次讀到或寫出數據的時間
+
+    ConnPhase phase;
+    uint64_t phase_start;
+    TimerNode timer;        // 只在事件循環持有連接時安排
+
+    struct HttpConnection* ready_next;
+} HttpConnection;
+
+typedef struct HttpLoop {
+    NetPoller* poller;
+    NetSocket* listener;
+    ThreadPool* pool;
+
+    TimerWheel timers;
+
+    Mutex* lock;
+    HttpConnection* ready;  // worker 處理完畢、等待歸還的連接
+} HttpLoop;
+
+void http_server_set_keep_alive(int max_requests, int idle_timeout_ms) {
+    g_config.max_requests = max_requests;
+    g_config.idle_timeout_ms = idle_timeout_ms;
+}
+
+void http_server_set_timeouts(int header_timeout_ms, int body_timeout_ms, int write_timeout_ms) {
+    g_config.header_timeout_ms = header_timeout_ms;
+    g_config.body_timeout_ms = body_timeout_ms;
+    g_config.write_timeout_ms = write_timeout_ms;
+}
+
+void http_server_set_write_high_water(size_t bytes) {
+    g_config.write_high_water = bytes;
+}
+
+static HttpConnection* conn_create(HttpLoop* loop, NetSocket* sock) {
+    HttpConnection* conn = calloc(1, sizeof(HttpConnection));
+    if (!conn) return NULL;
+    conn->sock = sock;
+    conn->loop = loop;
+    conn->keep_alive = 1;
+    conn->last_active = time_now_ms();
+    http_reader_init(&conn->reader);
+    http_writer_init(&conn->writer);
+    return conn;
+}
+
+static void conn_free(HttpConnection* conn) {
+    if (!conn) return;
+    net_close(conn->sock);
+    free(conn->buf);
+    http_writer_free(&conn->writer);    // 排隊的響應在讀取器的 arena 中，先釋放
+    http_reader_free(&conn->reader);
+    free(conn);
+}
+
+static int conn_over_high_water(const HttpConnection* conn) {
+    return conn->writer.count > 0 && conn->writer.pending >= g_config.write_high_water;
+}
+
+// 有待發送數據時關注可寫；輸出隊列超過高水位或接收緩衝區已滿時停止讀取，形成背壓
+static int conn_interest(const HttpConnection* conn) {
+    int events = 0;
+    if (conn->keep_alive && !conn->peer_closed && !conn_over_high_water(conn) &&
+        conn->len < CONN_MAX_BUFFER)
+        events |= NET_POLL_READ;
+    if (conn->writer.count > 0 && !http_writer_starved(&conn->writer))
+        events |= NET_POLL_WRITE;
+    return events;
+}
+
+// 按連接當前在等待的內容重新安排超時
+static void conn_arm_timer(HttpLoop* loop, HttpConnection* conn) {
+    ConnPhase phase;
+    int timeout;
+    if (conn->writer.count > 0) {
+        phase = CONN_WRITE;
+        timeout = g_config.write_timeout_ms;
+    } else if (conn->reader.req) {
+        phase = CONN_BODY;
+        timeout = g_config.body_timeout_ms;
+    } else if (conn->len > 0 || conn->reader.head.len > 0) {
+        // 不完整的請求頭可能已被解析器轉存，接收緩衝區為空也仍在等待請求頭
+        phase = CONN_HEADER;
+        timeout = g_config.header_timeout_ms;
+    } else {
+        phase = CONN_IDLE;
+        timeout = g_config.idle_timeout_ms;
+    }
+
+    uint64_t now = time_now_ms();
+    if (phase != conn->phase) {
+        conn->phase = phase;
+        conn->phase_start = now;
+    }
+
+    if (timeout <= 0 && conn->stream_idle) {
+        timer_wheel_schedule(&loop->timers, &conn->timer, now + HTTP_STREAM_RETRY_MS);
+        return;
+    }
+    if (timeout <= 0) {
+        timer_wheel_cancel(&loop->timers, &conn->timer);
+        return;
+    }
+
+    // 請求頭有總時限，防止逐字節慢速發送；其餘按最近一次進展計算
+    uint64_t base = phase == CONN_HEADER ? conn->phase_start : conn->last_active;
+    uint64_t deadline = base + (uint64_t)timeout;
+    if (conn->stream_idle && now + HTTP_STREAM_RETRY_MS < deadline)
+        deadline = now + HTTP_STREAM_RETRY_MS;
+    timer_wheel_schedule(&loop->timers, &conn->timer, deadline);
+}
+
+static int conn_watch(HttpLoop* loop, HttpConnection* conn) {
+    int events = conn_interest(conn);
+
+    if (!conn->watched) {
+        if (net_poller_add(loop->poller, conn->sock, events, conn) != 0)
+            return -1;
+        conn->watched = 1;
+        conn->events = events;
+    } else if (events != conn->events) {
+        if (net_poller_mod(loop->poller, conn->sock, events, conn) != 0) return -1;
+        conn->events = events;
+    }
+
+    conn_arm_timer(loop, conn);
+    return 0;
+}
+
+static void conn_unwatch(HttpLoop* loop, HttpConnection* conn) {
+    if (!conn->watched) return;
+
+    net_poller_del(loop->poller, conn->sock);
+    timer_wheel_cancel(&loop->timers, &conn->timer);
+    conn->watched = 0;
+}
+
+static void conn_close(HttpLoop* loop, HttpConnection* conn) {
+    conn_unwatch(loop, conn);
+    conn_free(conn);
+}
+
+// 讀到 EAGAIN 或 EOF 為止；返回 0 表示出錯
+static int conn_read(HttpConnection* conn) {
+    for (;;) {
+        if (conn->cap - conn->len < CONN_READ_CHUNK) {
+            size_t cap = conn->cap ? conn->cap * 2 : CONN_READ_CHUNK * 2;
+            char* nb = realloc(conn->buf, cap);
+            if (!nb) return 0;
+            conn->buf = nb;
+            conn->cap = cap;
+        }
+
+        int n = net_recv(conn->sock, conn->buf + conn->len, (int)(conn->cap - conn->len - 1));
+        if (n == NET_WOULD_BLOCK) break;
+        if (n == 0) {
+            conn->peer_closed = 1;
+            break;
+        }
+        if (n < 0) return 0;
+
+        conn->len += n;
+        conn->buf[conn->len] = '\0';
+        conn->last_active = time_now_ms();
+        conn->need_more = 0;
+        if (conn->len >= CONN_MAX_BUFFER) break;
+    }
+    return 1;
+}
+
+// 非阻塞地寫出輸出隊列；返回 -1 表示連接已不可用，2 表示流式響應在等待數據
+static int conn_flush(HttpConnection* conn) {
+    if (conn->writer.count == 0) return 1;
+
+    uint64_t before = conn->writer.pending;
+    int r = http_writer_flush(&conn->writer, conn->sock);
+    if (r < 0) {
+        LOG_DEBUG("Failed to write response, closing connection");
+        conn->broken = 1;
+        return -1;
+    }
+    if (conn->writer.pending != before)
+        conn->last_active = time_now_ms();
+    return r;
+}
+
+// 寫出輸出隊列，流式響應的數據發完後繼續調用 producer，直到 socket 不可寫或隊列寫完；
+// producer 沒有生成數據時停下，由定時器稍後重試，不在這裡空轉
+static void conn_pump(HttpConnection* conn) {
+    conn->stream_idle = 0;
+    while (conn_flush(conn) == 2) {
+        if (!http_writer_produce(&conn->writer)) {
+            conn->stream_idle = 1;
+            break;
+        }
+    }
+}
+
+static void conn_process(HttpConnection* conn) {
+    // 按到達順序處理緩衝區中的請求，響應排隊後聚合寫出；請求體按路由緩衝或流式交付。
+    // 輸出隊列超過高水位時停下，剩餘請求等隊列排空後再處理
+    size_t off = 0;
+    while (conn->keep_alive && !conn_over_high_water(conn)) {
+        // 之前的響應都已寫出，它們和請求佔用的內存一次回收
+        if (conn->writer.count == 0) http_reader_recycle(&conn->reader);
+
+        size_t used = 0;
+        HttpReadResult r = http_reader_feed(&conn->reader, conn->buf + off, conn->len - off, &used);
+        off += used;
+
+        if (conn->reader.expect_continue) {
+            http_writer_add_data(&conn->writer, HTTP_CONTINUE_LINE, strlen(HTTP_CONTINUE_LINE));
+            conn->reader.expect_continue = 0;
+        }
+
+        if (r == HTTP_READ_MORE) {
+            conn->need_more = 1;
+            break;
+        }
+
+        // 對端半關閉後仍回覆已到達的請求，輸出寫完後再關閉
+        int allow_keep_alive = r == HTTP_READ_DONE &&
+                               conn->requests + 1 < g_config.max_requests;
+        HttpResponse* res = http_reader_respond(&conn->reader, conn->sock, allow_keep_alive);
+        conn->requests++;
+        conn->phase = CONN_IDLE;    // 下一個請求重新計時
+        if (!res) {
+            conn->keep_alive = 0;
+            break;
+        }
+
+        conn->keep_alive = res->keep_alive;
+        if (http_writer_add_response(&conn->writer, res) != 0) {
+            LOG_ERROR("Failed to build HTTP response");
+            free_response(res);
+            conn->keep_alive = 0;
+            break;
+        }
+
+        if (conn->writer.pending >= CONN_FLUSH_BYTES && conn_flush(conn) < 0)
+            break;
+    }
+
+    // 寫不完的部分留給事件循環在可寫時繼續
+    if (!conn->broken)
+        conn_pump(conn);
+
+    // 丟棄已處理的請求，保留之後已到達的字節
+    conn->len -= off;
+    memmove(conn->buf, conn->buf + off, conn->len);
+    if (conn->buf) conn->buf[conn->len] = '\0';
+}
+
+static void* connection_task(void* arg) {
+    HttpConnection* conn = arg;
+    HttpLoop* loop = conn->loop;
+
+    conn_process(conn);
+
+    // 把連接歸還給事件循環
+    mutex_lock(loop->lock);
+    conn->ready_next = loop->ready;
+    loop->ready = conn;
+    mutex_unlock(loop->lock);
+    net_poller_wakeup(loop->poller);
+    return NULL;
+}
+
+// 決定連接的下一步：處理新收到的數據、繼續等待事件，或關閉。
+// 有線程池時交給 worker；沒有時直接在事件循環線程上處理
+static void conn_try_dispatch(HttpLoop* loop, HttpConnection* conn) {
+    for (;;) {
+        if (conn->broken) {
+            conn_close(loop, conn);
+            return;
+        }
+
+        int has_request = conn->keep_alive && !conn_over_high_water(conn) &&
+                          !conn->need_more && conn->len > 0;
+        if (!has_request && (!http_writer_starved(&conn->writer) || conn->stream_idle))
+            break;
+
+        if (loop->pool) {
+            conn_unwatch(loop, conn);
+            thread_pool_submit(loop->pool, connection_task, conn);
+            return;
+        }
+        conn_process(conn);
+    }
+
+    // 輸出已寫完且不會再有新請求
+    if (conn->writer.count == 0 && (!conn->keep_alive || conn->peer_closed)) {
+        conn_close(loop, conn);
+        return;
+    }
+    if (conn->writer.count == 0) http_reader_recycle(&conn->reader);
+
+    if (conn_watch(loop, conn) != 0) {
+        LOG_ERROR("Failed to register client connection");
+        conn_close(loop, conn);
+    }
+}
+
+static void on_accept(HttpLoop* loop) {
+    NetSocket* client;
+    while ((client = net_accept(loop->listener)) != NULL) {
+        HttpConnection* conn = conn_create(loop, client);
+        if (!conn || net_set_nonblocking(client, 1) != 0 || conn_watch(loop, conn) != 0) {
+            LOG_ERROR("Failed to register client connection");
+            if (conn) conn_free(conn);
+            else net_close(client);
+            continue;
+        }
+        LOG_TRACE("Accepted client %s:%d", net_get_ip(client), net_get_port(client));
+    }
+}
+
+static void on_conn_event(HttpLoop* loop, HttpConnection* conn, int events) {
+    if ((events & (NET_POLL_WRITE | NET_POLL_ERROR)) && conn->writer.count > 0) {
+        if (conn_flush(conn) < 0) {
+            conn_close(loop, conn);
+            return;
+        }
+    }
+
+    if ((events & (NET_POLL_READ | NET_POLL_ERROR)) && (conn->events & NET_POLL_READ)) {
+        if (!conn_read(conn)) {
+            LOG_DEBUG("Client disconnected");
+            conn_close(loop, conn);
+            return;
+        }
+    }
+
+    conn_try_dispatch(loop, conn);
+}
+
+static void drain_ready(HttpLoop* loop) {
+    mutex_lock(loop->lock);
+    HttpConnection* conn = loop->ready;
+    loop->ready = NULL;
+    mutex_unlock(loop->lock);
+
+    while (conn) {
+        HttpConnection* next = conn->ready_next;
+        conn->ready_next = NULL;
+        // producer 沒有生成數據不算進展，否則寫超時永遠不會到
+        if (!conn->stream_idle) conn->last_active = time_now_ms();
+        conn_try_dispatch(loop, conn);
+        conn = next;
+    }
+}
+
+static const char* phase_name(ConnPhase phase) {
+    switch (phase) {
+    case CONN_HEADER: return "header";
+    case CONN_BODY:   return "body";
+    case CONN_WRITE:  return "write";
+    default:          return "idle";
+    }
+}
+
+static void on_timeout(TimerNode* t, void* ctx) {
+    HttpLoop* loop = ctx;
+    HttpConnection* conn = (HttpConnection*)((char*)t - offsetof(HttpConnection, timer));
+    int timeout = g_config.write_timeout_ms;
+    if (conn->stream_idle && (timeout <= 0 || time_now_ms() < conn->last_active + (uint64_t)timeout)) {
+        // 還沒到寫超時，再調用一次 producer
+        conn->stream_idle = 0;
+        conn_try_dispatch(loop, conn);
+        return;
+    }
+    LOG_DEBUG("Closing connection after %s timeout", phase_name(conn->phase));
+    conn_close(loop, conn);
+}
+
+static int loop_init(HttpLoop* loop, NetSocket* server, ThreadPool* pool) {
+    memset(loop, 0, sizeof(HttpLoop));
+    loop->listener = server;
+    loop->pool = pool;
+    timer_wheel_init(&loop->timers, time_now_ms(), LOOP_TIMER_TICK_MS);
+    loop->lock = mutex_create();
+    loop->poller = net_poller_create();
+    if (!loop->poller || !loop->lock) {
+        LOG_FATAL("Failed to create poller");
+        net_poller_free(loop->poller);
+        mutex_free(loop->lock);
+        return -1;
+    }
+
+    net_set_nonblocking(server, 1);
+    // 監聽 socket 的 udata 指向 loop 本身，以便和連接區分
+    if (net_poller_add(loop->poller, server, NET_POLL_READ, loop) != 0) {
+        LOG_FATAL("Failed to register listening socket");
+        net_poller_free(loop->poller);
+        mutex_free(loop->lock);
+        return -1;
+    }
+    return 0;
+}
+
+static void loop_run(HttpLoop* loop) {
+    NetPollEvent events[LOOP_MAX_EVENTS];
+    for (;;) {
+        int timeout = timer_wheel_next_timeout(&loop->timers, time_now_ms(), LOOP_WAIT_MS);
+        int n = net_poller_wait(loop->poller, events, LOOP_MAX_EVENTS, timeout);
+        if (n < 0) {
+            LOG_ERROR("Poller wait failed");
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (events[i].udata == loop) {
+                on_accept(loop);
+            } else {
+                on_conn_event(loop, events[i].udata, events[i].events);
+            }
+        }
+
+        drain_ready(loop);
+        timer_wheel_advance(&loop->timers, time_now_ms(), on_timeout, loop);
+    }
+
+    net_poller_del(loop->poller, loop->listener);
+    net_poller_free(loop->poller);
+    mutex_free(loop->lock);
+}
+
+void http_server_run(NetSocket* server, ThreadPool* pool) {
+    if (!server) return;
+
+    HttpLoop loop;
+    if (loop_init(&loop, server, pool) != 0) return;
+    loop_run(&loop);
+}
+
+typedef struct HttpReactor {
+    HttpLoop loop;
+    Thread* thread;
+    NetSocket* listener;
+    int owns_listener;
+} HttpReactor;
+
+static void reactor_main(void* arg) {
+    HttpReactor* r = arg;
+    loop_run(&r->loop);
+}
+
+void http_server_run_reuseport(const char* ip, uint16_t port, int n_reactors) {
+    int cpus = cpu_count();
+    if (n_reactors <= 0) n_reactors = cpus;
+
+    HttpReactor* reactors = calloc(n_reactors, sizeof(HttpReactor));
+    if (!reactors) {
+        LOG_FATAL("Failed to allocate reactors");
+        return;
+    }
+
+    // 每個 reactor 一個監聽 socket，由內核按連接分流；
+    // 平台不支持 SO_REUSEPORT 時退化為共享同一個監聽 socket
+    int shared = 0;
+    for (int i = 0; i < n_reactors; i++) {
+        HttpReactor* r = &reactors[i];
+        if (!shared) {
+            r->listener = net_tcp_listen_ex(ip, port, NET_LISTEN_REUSEPORT);
+            r->owns_listener = r->listener != NULL;
+        }
+        if (!r->listener) {
+            if (i == 0) {
+                r->listener = net_tcp_listen(ip, port);
+                r->owns_listener = r->listener != NULL;
+            } else {
+                r->listener = reactors[0].listener;
+            }
+            if (!shared) LOG_WARN("SO_REUSEPORT unavailable, reactors share one listener");
+            shared = 1;
+        }
+        if (!r->listener) {
+            LOG_FATAL("Failed to listen on %s:%d", ip, port);
+            n_reactors = i;
+            break;
+        }
+    }
+
+    int started = 0;
+    for (int i = 0; i < n_reactors; i++) {
+        HttpReactor* r = &reactors[i];
+        if (loop_init(&r->loop, r->listener, NULL) != 0) break;
+        r->thread = thread_create(reactor_main, r);
+        if (!r->thread) {
+            LOG_FATAL("Failed to start reactor thread");
+            net_poller_free(r->loop.poller);
+            mutex_free(r->loop.lock);
+            break;
+        }
+        thread_set_affinity(r->thread, i % cpus);
+        started++;
+    }
+
+    LOG_INFO("Started %d reactors on %s:%d", started, ip, port);
+
+    for (int i = 0; i < started; i++) {
+        thread_join(reactors[i].thread);
+        thread_free(reactors[i].thread);
+    }
+    for (int i = 0; i < n_reactors; i++) {
+        if (reactors[i].owns_listener) net_close(reactors[i].listener);
+    }
+    free(reactors);
+}
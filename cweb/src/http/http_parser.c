@@ -1,81 +1,404 @@
 #include "http/http_paser_internal.h"
+#include "http/http_scan_internal.h"
+
 #include <stdlib.h>
 #include <string.h>
-#include <stdio.h>
-
-static HttpMethod parse_method(const char* s) {
-    if (!s) return GET;
-    if (strcmp(s,"GET")==0) return GET;
-    if (strcmp(s,"POST")==0) return POST;
-    if (strcmp(s,"PUT")==0) return PUT;
-    if (strcmp(s,"DELETE")==0) return DEL;
+#include <ctype.h>
+
+static int view_is(const char* s, size_t len, const char* lit) {
+    return strlen(lit) == len && memcmp(s, lit, len) == 0;
+}
+
+static HttpMethod parse_method(const char* s, size_t len) {
+    if (view_is(s, len, "GET")) return GET;
+    if (view_is(s, len, "POST")) return POST;
+    if (view_is(s, len, "PUT")) return PUT;
+    if (view_is(s, len, "DELETE")) return DEL;
     return GET;
 }
 
-HttpRequest* parse_http_request(const char* raw, size_t len) {
-    if (!raw || len == 0) return NULL;
+static HttpStrView make_view(size_t off, size_t len) {
+    HttpStrView v = { (uint32_t)off, (uint32_t)len };
+    return v;
+}
+
+static int is_ows(char c) {
+    return c == ' ' || c == '\t';
+}
+
+// ======== 請求頭解析 ========
+enum {
+    HEAD_REQUEST_LINE,
+    HEAD_HEADERS
+};
+
+void http_head_parser_init(HttpHeadParser* p, size_t max_bytes, size_t max_headers) {
+    memset(p, 0, sizeof(HttpHeadParser));
+    p->max_bytes = max_bytes;
+    p->max_headers = max_headers;
+}
+
+void http_head_parser_free(HttpHeadParser* p) {
+    if (!p) return;
+    free(p->buf);
+    free(p->headers);
+    memset(p, 0, sizeof(HttpHeadParser));
+}
+
+void http_head_parser_reset(HttpHeadParser* p) {
+    p->state = HEAD_REQUEST_LINE;
+    p->len = 0;
+    p->line_start = 0;
+    p->header_count = 0;
+    p->error_status = 0;
+}
+
+static int head_fail(HttpHeadParser* p, int status) {
+    p->error_status = status;
+    return -1;
+}
+
+static int head_append(HttpHeadParser* p, const char* data, size_t len) {
+    if (p->cap - p->len < len) {
+        size_t cap = p->cap ? p->cap : 1024;
+        while (cap - p->len < len) cap *= 2;
+        char* nb = realloc(p->buf, cap);
+        if (!nb) return -1;
+        p->buf = nb;
+        p->cap = cap;
+    }
+    memcpy(p->buf + p->len, data, len);
+    p->len += len;
+    return 0;
+}
 
-    HttpRequest* req = malloc(sizeof(HttpRequest));
+// 每個字段用 http_scan 一次找到分隔符並校驗字符；CTL（含 '\0' 和單獨的 CR）
+// 都會使掃描提前停下，從而被拒絕
+
+// 請求行：METHOD SP request-target SP HTTP-version CRLF
+static int parse_request_line(HttpHeadParser* p, const char* line, size_t off, size_t n) {
+    const char* end = line + n;     // 指向 CR
+    const char* s = line;
+    size_t k = http_scan(s, end - s, HTTP_CHARS_TOKEN);
+    if (k == 0 || s[k] != ' ') return -1;
+    p->method = parse_method(s, k);
+
+    s += k + 1;
+    k = http_scan(s, end - s, HTTP_CHARS_TARGET);
+    if (k == 0 || s[k] != ' ') return -1;
+    // 路徑和查詢字符串在這裡分開，路徑在 build_request 中解碼
+    const char* q = memchr(s, '?', k);
+    p->has_query = q != NULL;
+    if (q) {
+        p->route = make_view(off + (s - line), q - s);
+        p->query = make_view(off + (q + 1 - line), k - (q + 1 - s));
+    } else {
+        p->route = make_view(off + (s - line), k);
+        p->query = make_view(0, 0);
+    }
+
+    s += k + 1;
+    k = http_scan(s, end - s, HTTP_CHARS_TARGET);
+    if (k == 0 || s + k != end) return -1;
+    p->version = make_view(off + (s - line), k);
+    return 0;
+}
+
+// 頭部：token ":" OWS value OWS CRLF；折疊行和冒號前的空白都不是 token 字符
+static int parse_header_line(HttpHeadParser* p, const char* line, size_t off, size_t n) {
+    const char* end = line + n;
+    size_t k = http_scan(line, n, HTTP_CHARS_TOKEN);
+    if (k == 0 || line[k] != ':') return head_fail(p, 400);
+
+    const char* v = line + k + 1;
+    if (v + http_scan(v, end - v, HTTP_CHARS_VALUE) != end) return head_fail(p, 400);
+    const char* ve = end;
+    while (v < ve && is_ows(*v)) v++;
+    while (ve > v && is_ows(ve[-1])) ve--;
+
+    if (p->header_count == p->max_headers) return head_fail(p, 431);
+    if (p->header_count == p->header_cap) {
+        size_t cap = p->header_cap ? p->header_cap * 2 : 16;
+        HttpHeaderView* nh = realloc(p->headers, cap * sizeof(HttpHeaderView));
+        if (!nh) return head_fail(p, 400);
+        p->headers = nh;
+        p->header_cap = cap;
+    }
+    HttpHeaderView* h = &p->headers[p->header_count++];
+    h->key = make_view(off, k);
+    h->value = make_view(off + (v - line), ve - v);
+    h->id = http_header_lookup(line, k);
+    h->hash = h->id < 0 ? http_header_hash(line, k) : 0;
+    return 0;
+}
+
+// 解析請求頭中 [start, end) 這一整行（含 CRLF）；返回 1 表示遇到結尾的空行
+static int parse_line(HttpHeadParser* p, const char* head, size_t start, size_t end) {
+    const char* line = head + start;
+    size_t n = end - start - 1;
+    if (n == 0 || line[n - 1] != '\r') return head_fail(p, 400);
+    n--;
+
+    if (p->state == HEAD_REQUEST_LINE) {
+        if (parse_request_line(p, line, start, n) != 0) return head_fail(p, 400);
+        p->state = HEAD_HEADERS;
+        return 0;
+    }
+    if (n == 0) return 1;
+    return parse_header_line(p, line, start, n);
+}
+
+// 請求、頭部索引和請求頭原文放入同一塊內存，各字段就地以 '\0' 結尾；
+// 路徑非法（轉義錯誤）或內存不足時返回 NULL
+static HttpRequest* build_request(const HttpHeadParser* p, const char* head, size_t len, HttpArena* arena) {
+    size_t count = p->header_count;
+    // 末尾為路由參數預留路徑的副本和參數名
+    HttpRequest* req = http_arena_alloc(arena, sizeof(HttpRequest) + count * sizeof(HttpHeaderView) +
+                                               len + 1 + p->route.len + 1 + HTTP_ROUTE_PARAM_NAME_BYTES);
     if (!req) return NULL;
     memset(req, 0, sizeof(HttpRequest));
+    req->arena = arena;
+    req->headers = (HttpHeaderView*)(req + 1);
+    req->head = (char*)(req->headers + count);
+    memcpy(req->head, head, len);
+    req->head[len] = '\0';
+    req->param_buf = req->head + len + 1;
+    if (count > 0) memcpy(req->headers, p->headers, count * sizeof(HttpHeaderView));
+    req->header_count = count;
 
-    const char* line = raw;
-    const char* next = strstr(line, "\r\n");
-    if (!next) { free(req); return NULL; }
+    req->method = p->method;
+    req->route = p->route;
+    req->query = p->query;
+    req->has_query = p->has_query;
+    req->version = p->version;
+    if (p->has_query) req->head[p->query.off + p->query.len] = '\0';
+    req->head[p->version.off + p->version.len] = '\0';
 
-    // 解析请求行
-    char request_line[512];
-    size_t rl_len = next - line;
-    if (rl_len >= sizeof(request_line)) rl_len = sizeof(request_line) - 1;
-    strncpy(request_line, line, rl_len);
-    request_line[rl_len] = '\0';
+    // 解碼後不會變長，就地進行；非法轉義回覆 400
+    size_t route_len;
+    if (http_percent_decode(req->head + p->route.off, p->route.len, 0, &route_len) != 0)
+        return NULL;
+    req->route.len = (uint32_t)route_len;
+    req->head[req->route.off + req->route.len] = '\0';
+    for (size_t i = 0; i < count; i++) {
+        const HttpHeaderView* h = &req->headers[i];
+        req->head[h->key.off + h->key.len] = '\0';
+        req->head[h->value.off + h->value.len] = '\0';
+        // 同名頭部以第一個為準
+        if (h->id >= 0 && !req->known[h->id]) req->known[h->id] = (uint16_t)(i + 1);
+    }
+    return req;
+}
 
-    char method[16], route[256], version[16];
-    sscanf(request_line, "%15s %255s %15s", method, route, version);
+int http_head_parser_feed(HttpHeadParser* p, const char* data, size_t len, size_t* consumed,
+                          HttpArena* arena, HttpRequest** out) {
+    *consumed = 0;
+    *out = NULL;
+    if (p->error_status) return -1;
 
-    req->method = parse_method(method);
-    strncpy(req->route, route, sizeof(req->route)-1);
-    strncpy(req->version, version, sizeof(req->version)-1);
+    // 沒有上次殘留的字節時直接在 data 上解析，請求頭在一個分片內到齊時無需轉存；
+    // 否則把新字節追加到緩衝區，偏移始終相對請求頭開頭
+    int direct = p->len == 0;
+    size_t head_len = p->len;
+    size_t off = 0;
 
-    line = next + 2;
+    while (off < len) {
+        const char* lf = memchr(data + off, '\n', len - off);
+        size_t take = lf ? (size_t)(lf - data) + 1 - off : len - off;
+        if (head_len + take > p->max_bytes) {
+            *consumed = off;
+            return head_fail(p, 431);
+        }
+        if (!direct && head_append(p, data + off, take) != 0) {
+            *consumed = off;
+            return head_fail(p, 400);
+        }
+        head_len += take;
+        off += take;
+        if (!lf) break;
 
-    // 解析 headers
-    while (line < raw + len) {
-        next = strstr(line, "\r\n");
-        if (!next) break;
-        if (next == line) { // 空行，headers结束
-            line += 2;
-            break;
+        const char* head = direct ? data : p->buf;
+        int r = parse_line(p, head, p->line_start, head_len);
+        p->line_start = head_len;
+        *consumed = off;
+        if (r < 0) return -1;
+        if (r == 1) {
+            *out = build_request(p, head, head_len, arena);
+            http_head_parser_reset(p);
+            return *out ? 1 : head_fail(p, 400);
+        }
+    }
+
+    // 請求頭尚未完整：本次處理過的字節轉存起來，下次只需掃描新到的數據
+    if (direct && off > 0 && head_append(p, data, off) != 0) return head_fail(p, 400);
+    *consumed = off;
+    return 0;
+}
+
+// ======== 請求體解碼 ========
+enum {
+    BODY_LENGTH,        // 按 Content-Length 讀取
+    BODY_CHUNK_SIZE,    // 等待 chunk 大小行
+    BODY_CHUNK_DATA,
+    BODY_CHUNK_CRLF,    // chunk 數據後的 CRLF
+    BODY_TRAILER,       // 最後一個 chunk 之後的 trailer 行
+    BODY_DONE
+};
+
+#define CHUNK_LINE_MAX 1024
+
+// Content-Length 只能是一個十進制數，列表（"5, 5"）、符號和溢出都不接受
+static int parse_content_length(const char* s, uint64_t* out) {
+    uint64_t v = 0;
+    if (!isdigit((unsigned char)*s)) return -1;
+    for (; isdigit((unsigned char)*s); s++) {
+        unsigned d = (unsigned)(*s - '0');
+        if (v > (UINT64_MAX - d) / 10) return -1;
+        v = v * 10 + d;
+    }
+    if (*s) return -1;
+    *out = v;
+    return 0;
+}
+
+static int is_chunked(const char* s, size_t len) {
+    static const char chunked[] = "chunked";
+    if (len != sizeof(chunked) - 1) return 0;
+    for (size_t i = 0; i < len; i++) {
+        if ((s[i] | 0x20) != chunked[i]) return 0;
+    }
+    return 1;
+}
+
+// 把 Transfer-Encoding 的值逐個編碼計數，記錄 chunked 的位置；多個同名頭部按順序連成一個列表
+static void count_codings(const char* value, int* count, int* chunked_at, int* chunked_count) {
+    const char* p = value;
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        if (!*p) break;
+        const char* start = p;
+        while (*p && *p != ',') p++;
+        const char* end = p;
+        while (end > start && (end[-1] == ' ' || end[-1] == '\t')) end--;
+        if (is_chunked(start, end - start)) {
+            *chunked_at = *count;
+            (*chunked_count)++;
         }
+        (*count)++;
+    }
+}
 
-        char header_line[512];
-        size_t hl_len = next - line;
-        if (hl_len >= sizeof(header_line)) hl_len = sizeof(header_line)-1;
-        strncpy(header_line, line, hl_len);
-        header_line[hl_len] = '\0';
-
-        char* sep = strstr(header_line, ":");
-        if (sep && req->headers.count < MAX_HEADER_SIZE) {
-            *sep = '\0';
-            sep++;
-            while (*sep == ' ') sep++;
-            strncpy(req->headers.items[req->headers.count].key, header_line, 63);
-            strncpy(req->headers.items[req->headers.count].value, sep, 255);
-            req->headers.count++;
+// 請求體的長度必須沒有歧義，否則前後兩級代理可能對請求邊界理解不同（請求走私）：
+// 所有 Content-Length 必須相同，Transfer-Encoding 的最後一個編碼必須是 chunked 且只出現一次，
+// 兩者不能同時出現
+int http_body_decoder_init(HttpBodyDecoder* d, const HttpRequest* req) {
+    memset(d, 0, sizeof(HttpBodyDecoder));
+
+    int has_cl = 0, has_te = 0;
+    uint64_t cl = 0;
+    int codings = 0, chunked_at = -1, chunked_count = 0;
+    for (size_t i = 0; i < req->header_count; i++) {
+        const HttpHeaderView* h = &req->headers[i];
+        const char* value = http_view_str(req, h->value);
+        if (h->id == HTTP_HEADER_CONTENT_LENGTH) {
+            uint64_t v;
+            if (parse_content_length(value, &v) != 0 || (has_cl && v != cl)) return -1;
+            has_cl = 1;
+            cl = v;
+        } else if (h->id == HTTP_HEADER_TRANSFER_ENCODING) {
+            has_te = 1;
+            count_codings(value, &codings, &chunked_at, &chunked_count);
         }
+    }
 
-        line = next + 2;
+    if (has_te) {
+        if (has_cl || chunked_count != 1 || chunked_at != codings - 1) return -1;
+        d->chunked = 1;
+        d->state = BODY_CHUNK_SIZE;
+        return 0;
     }
 
-    // 解析 body
-    size_t body_len = raw + len - line;
-    if (body_len > 0) {
-        req->content = malloc(body_len);
-        if (req->content) {
-            memcpy(req->content, line, body_len);
-            req->content_length = body_len;
+    d->remaining = cl;
+    d->content_length = cl;
+    d->state = d->remaining > 0 ? BODY_LENGTH : BODY_DONE;
+    return 0;
+}
+
+int http_body_done(const HttpBodyDecoder* d) {
+    return d->state == BODY_DONE;
+}
+
+// 取出一整行（不含 CRLF），不完整時返回 0。與請求頭一樣只接受 CRLF：單獨的 LF、行內的 CR
+// 或其他控制字符返回 -1，避免與前面的代理對 chunk 邊界理解不同
+static int take_line(const char* p, size_t len, size_t* line_len, size_t* used) {
+    const char* eol = memchr(p, '\n', len);
+    if (!eol) return 0;
+    size_t n = eol - p;
+    if (n == 0 || p[n - 1] != '\r') return -1;
+    for (size_t i = 0; i + 1 < n; i++) {
+        unsigned char c = (unsigned char)p[i];
+        if ((c < 0x20 && c != '\t') || c == 0x7f) return -1;
+    }
+    *used = n + 1;
+    *line_len = n - 1;
+    return 1;
+}
+
+int http_body_decode(HttpBodyDecoder* d, const char* data, size_t len, size_t* consumed,
+                     HttpBodyEmit emit, void* ctx) {
+    size_t off = 0;
+    int r = 0;
+
+    while (d->state != BODY_DONE) {
+        const char* p = data + off;
+        size_t left = len - off;
+
+        if (d->state == BODY_LENGTH || d->state == BODY_CHUNK_DATA) {
+            if (left == 0) break;
+            size_t n = d->remaining < left ? (size_t)d->remaining : left;
+            off += n;
+            d->remaining -= n;
+            if (d->remaining == 0)
+                d->state = d->state == BODY_LENGTH ? BODY_DONE : BODY_CHUNK_CRLF;
+            if (emit(ctx, p, n) != 0) { r = -2; break; }
+            continue;
+        }
+
+        size_t line_len, used;
+        int t = take_line(p, left, &line_len, &used);
+        if (t < 0) { r = -1; break; }
+        if (t == 0) {
+            if (left > CHUNK_LINE_MAX) r = -1;
+            break;
+        }
+        if (line_len > CHUNK_LINE_MAX) { r = -1; break; }
+        off += used;
+
+        if (d->state == BODY_CHUNK_SIZE) {
+            // 大小為十六進制，忽略 ';' 之後的擴展
+            uint64_t size = 0;
+            size_t i = 0, digits = 0;
+            for (; i < line_len && isxdigit((unsigned char)p[i]); i++, digits++) {
+                if (digits >= 15) { r = -1; break; }
+                int c = tolower((unsigned char)p[i]);
+                size = size * 16 + (uint64_t)(c <= '9' ? c - '0' : c - 'a' + 10);
+            }
+            if (r < 0) break;
+            if (digits == 0 || (i < line_len && p[i] != ';' && p[i] != ' ' && p[i] != '\t')) {
+                r = -1;
+                break;
+            }
+            d->remaining = size;
+            d->state = size > 0 ? BODY_CHUNK_DATA : BODY_TRAILER;
+        } else if (d->state == BODY_CHUNK_CRLF) {
+            if (line_len != 0) { r = -1; break; }
+            d->state = BODY_CHUNK_SIZE;
+        } else if (line_len == 0) {
+            d->state = BODY_DONE;   // trailer 以空行結束，內容忽略
         }
     }
 
-    return req;
-}
\ No newline at end of file
+    if (consumed) *consumed = off;
+    if (r < 0) return r;
+    return d->state == BODY_DONE ? 1 : 0;
+}
@@ -1,8 +1,62 @@
 #ifndef HTTP_PASER_INTERNAL_H
 #define HTTP_PASER_INTERNAL_H
 
+#include "http/http_arena_internal.h"
 #include "http/http_request_internal.h"
 
-HttpRequest* parse_http_request(const char* raw, size_t len);
+#include <stdint.h>
+#include <stddef.h>
+
+// 增量解析請求頭：可按任意分片餵入，狀態保存在調用之間，已處理的字節不會重新掃描
+typedef struct HttpHeadParser {
+    int state;
+    char* buf;                  // 跨越多次調用的請求頭字節
+    size_t len;
+    size_t cap;
+    size_t line_start;          // 當前未完成行在請求頭中的偏移
+
+    HttpMethod method;
+    HttpStrView route;
+    HttpStrView query;
+    int has_query;
+    HttpStrView version;
+    HttpHeaderView* headers;
+    size_t header_count;
+    size_t header_cap;
+
+    size_t max_bytes;           // 請求行加頭部的總字節上限
+    size_t max_headers;
+    int error_status;           // 出錯後應回覆的狀態碼：400 格式錯誤，431 超過上限
+} HttpHeadParser;
+
+void http_head_parser_init(HttpHeadParser* p, size_t max_bytes, size_t max_headers);
+void http_head_parser_free(HttpHeadParser* p);
+void http_head_parser_reset(HttpHeadParser* p);     // 丟棄未完成的請求頭和錯誤狀態，保留緩衝區
+
+// 消耗 data 中屬於請求頭的字節，之後的字節（請求體或下一個請求）不消耗，consumed 輸出消耗的字節數。
+// 返回 1 請求頭完整，out 輸出在 arena 中分配的請求，解析器隨即可用於下一個請求；0 需要更多數據；-1 非法
+int http_head_parser_feed(HttpHeadParser* p, const char* data, size_t len, size_t* consumed,
+                          HttpArena* arena, HttpRequest** out);
+
+// 按 Content-Length 或 chunked 編碼增量解碼請求體
+typedef struct HttpBodyDecoder {
+    int chunked;
+    int state;
+    uint64_t remaining;         // Content-Length 剩餘字節，或當前 chunk 剩餘字節
+    uint64_t content_length;    // 非 chunked 時的總長度
+} HttpBodyDecoder;
+
+// 收到一段解碼後的 body，返回非 0 中止解碼
+typedef int (*HttpBodyEmit)(void* ctx, const char* data, size_t len);
+
+// 根據全部請求頭初始化；長度有歧義（Content-Length 非數字或互相矛盾、chunked 不是最後一個編碼、
+// 兩者同時出現等）時返回 -1
+int http_body_decoder_init(HttpBodyDecoder* d, const HttpRequest* req);
+int http_body_done(const HttpBodyDecoder* d);
+
+// 解碼 data，consumed 輸出已消耗的字節；不完整的 chunk 大小行留在原處等待更多數據
+// 返回 1 body 已結束，0 需要更多數據，-1 格式錯誤，-2 emit 中止
+int http_body_decode(HttpBodyDecoder* d, const char* data, size_t len, size_t* consumed,
+                     HttpBodyEmit emit, void* ctx);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "http/http_reader_internal.h"
+#include "http/http_internal.h"
+#include "http/http_request_internal.h"
+#include "http/http_response_internal.h"
+
+#include "utils/log/logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static size_t g_max_body_size = HTTP_DEFAULT_MAX_BODY_SIZE;
+static size_t g_max_header_bytes = HTTP_MAX_HEADER_BYTES;
+static size_t g_max_headers = HTTP_DEFAULT_MAX_HEADERS;
+
+void http_server_set_max_body_size(size_t bytes) {
+    g_max_body_size = bytes;
+}
+
+void http_server_set_max_header_size(size_t bytes, size_t max_headers) {
+    // 字段以 32 位偏移記錄，常用頭部的下標以 16 位記錄
+    g_max_header_bytes = bytes < UINT32_MAX ? bytes : UINT32_MAX;
+    g_max_headers = max_headers < UINT16_MAX ? max_headers : UINT16_MAX;
+}
+
+void http_reader_init(HttpReader* r) {
+    memset(r, 0, sizeof(HttpReader));
+    http_head_parser_init(&r->head, g_max_header_bytes, g_max_headers);
+    http_arena_init(&r->arena);
+}
+
+static int is_streaming(const HttpReader* r) {
+    return r->route && r->route->on_chunk;
+}
+
+// 準備讀取下一個請求，保留請求頭解析器的緩衝區
+static void reader_reset(HttpReader* r) {
+    r->req = NULL;
+    r->route = NULL;
+    memset(&r->body, 0, sizeof(HttpBodyDecoder));
+    r->body_cap = 0;
+    r->error_status = 0;
+    r->expect_continue = 0;
+    http_head_parser_reset(&r->head);
+}
+
+// 請求在 handler 執行前終止：通知流式路由釋放狀態
+static void reader_abort(HttpReader* r) {
+    if (r->req && is_streaming(r))
+        r->route->on_chunk(r->req, NULL, 0);
+    reader_reset(r);
+}
+
+void http_reader_free(HttpReader* r) {
+    if (!r) return;
+    reader_abort(r);
+    http_head_parser_free(&r->head);
+    http_arena_free(&r->arena);
+}
+
+void http_reader_recycle(HttpReader* r) {
+    if (!r->req) http_arena_reset(&r->arena);
+}
+
+static int reader_emit(void* ctx, const char* data, size_t len) {
+    HttpReader* r = ctx;
+    HttpRequest* req = r->req;
+
+    if (is_streaming(r)) {
+        if (r->route->on_chunk(req, data, len) != 0) {
+            r->error_status = 400;
+            return -1;
+        }
+        return 0;
+    }
+
+    if (len > g_max_body_size - req->content_length) {
+        r->error_status = 413;
+        return -1;
+    }
+
+    size_t need = req->content_length + len + 1;   // 留出 '\0'
+    if (need > r->body_cap) {
+        size_t cap = r->body_cap ? r->body_cap : 4096;
+        while (cap < need) cap *= 2;
+        char* nb = http_arena_grow(&r->arena, req->content, r->body_cap, cap);
+        if (!nb) {
+            r->error_status = 413;
+            return -1;
+        }
+        req->content = nb;
+        r->body_cap = cap;
+    }
+
+    memcpy(req->content + req->content_length, data, len);
+    req->content_length += len;
+    req->content[req->content_length] = '\0';
+    return 0;
+}
+
+// 請求頭已解析：根據路由決定 body 的接收方式
+static int reader_begin(HttpReader* r) {
+    if (http_body_decoder_init(&r->body, r->req) != 0) return 400;
+
+    r->route = http_find_route(r->req, &r->route_entry);
+    if (!is_streaming(r) && r->body.content_length > g_max_body_size) return 413;
+
+    if (!http_body_done(&r->body)) {
+        const char* expect = http_request_get_known_header(r->req, HTTP_HEADER_EXPECT);
+        if (expect && http_header_has_token(expect, "100-continue") &&
+            http_request_is_http11(r->req))
+            r->expect_continue = 1;
+
+        // 已知長度時一次分配好緩衝區
+        if (!is_streaming(r) && r->body.content_length > 0) {
+            size_t cap = (size_t)r->body.content_length + 1;
+            r->req->content = http_arena_alloc(&r->arena, cap);
+            if (r->req->content) r->body_cap = cap;
+        }
+    }
+    return 0;
+}
+
+HttpReadResult http_reader_feed(HttpReader* r, const char* data, size_t len, size_t* consumed) {
+    size_t off = 0;
+    *consumed = 0;
+    if (r->error_status) return HTTP_READ_ERROR;
+
+    if (!r->req) {
+        int h = http_head_parser_feed(&r->head, data, len, &off, &r->arena, &r->req);
+        *consumed = off;
+        if (h == 0) return HTTP_READ_MORE;
+        if (h < 0) {
+            r->error_status = r->head.error_status;
+            return HTTP_READ_ERROR;
+        }
+
+        r->error_status = reader_begin(r);
+        if (r->error_status) return HTTP_READ_ERROR;
+    }
+
+    if (!http_body_done(&r->body)) {
+        size_t used = 0;
+        int d = http_body_decode(&r->body, data + off, len - off, &used, reader_emit, r);
+        off += used;
+        *consumed = off;
+        if (d < 0) {
+            if (!r->error_status) r->error_status = 400;
+            return HTTP_READ_ERROR;
+        }
+        if (d == 0) return HTTP_READ_MORE;
+    }
+    return HTTP_READ_DONE;
+}
+
+static const char* error_text(int status) {
+    switch (status) {
+    case 413: return "Payload Too Large";
+    case 431: return "Request Header Fields Too Large";
+    default:  return "Bad Request";
+    }
+}
+
+HttpResponse* http_reader_respond(HttpReader* r, NetSocket* client, int allow_keep_alive) {
+    if (!r->error_status) {
+        HttpResponse* res = http_dispatch_request(client, r->req, r->route, allow_keep_alive);
+        reader_reset(r);
+        return res;
+    }
+
+    int status = r->error_status;
+    LOG_WARN("Rejecting request from %s:%d with %d", net_get_ip(client), net_get_port(client), status);
+    reader_abort(r);
+
+    HttpResponse* res = http_response_create(&r->arena);
+    if (!res) return NULL;
+    http_response_set_status(res, status, error_text(status));
+    http_response_set_text(res, error_text(status));
+    return res;
+}
@@ -0,0 +1,44 @@
+#ifndef HTTP_READER_INTERNAL_H
+#define HTTP_READER_INTERNAL_H
+
+#include "http/http_paser_internal.h"
+#include "http/http_server_internal.h"
+
+#include <stddef.h>
+
+#define HTTP_CONTINUE_LINE "HTTP/1.1 100 Continue\r\n\r\n"
+
+typedef enum HttpReadResult {
+    HTTP_READ_MORE,     // 需要更多數據
+    HTTP_READ_DONE,     // 請求已完整，可以生成響應
+    HTTP_READ_ERROR     // 請求非法，應回覆錯誤並關閉連接
+} HttpReadResult;
+
+// 從字節流中增量讀取請求：先解析頭部，再按路由的模式緩衝或流式交付 body
+typedef struct HttpReader {
+    HttpHeadParser head;        // 在同一連接的各個請求間複用
+    HttpArena arena;            // 請求和響應的內存，響應寫出後由 http_reader_recycle 回收
+    HttpRequest* req;           // 頭部已解析、body 尚未讀完的請求
+    const RouteEntry* route;    // 指向 route_entry，沒有匹配的路由時為 NULL
+    RouteEntry route_entry;     // 路由表可能在請求處理期間被替換，這裡保存一份副本
+    HttpBodyDecoder body;
+    size_t body_cap;            // 緩衝模式下 req->content 的容量
+    int error_status;
+    int expect_continue;        // 客戶端在等待 100 Continue，由調用方發送後清零
+} HttpReader;
+
+void http_reader_init(HttpReader* r);
+void http_reader_free(HttpReader* r);
+
+// 消耗 data 中的字節推進當前請求，consumed 輸出已消耗的字節數；
+// 未消耗的字節應保留，與之後收到的數據一起再次傳入
+HttpReadResult http_reader_feed(HttpReader* r, const char* data, size_t len, size_t* consumed);
+
+// 之前生成的響應都已寫出並釋放後調用，回收 arena；正在讀取請求時不做任何事
+void http_reader_recycle(HttpReader* r);
+
+// 在 HTTP_READ_DONE 或 HTTP_READ_ERROR 之後調用：生成響應並重置讀取器
+// 錯誤響應總是關閉連接。響應分配在讀取器的 arena 中，不能比讀取器活得更久
+HttpResponse* http_reader_respond(HttpReader* r, NetSocket* client, int allow_keep_alive);
+
+#endif
@@ -4,32 +4,303 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <ctype.h>
 
 HttpMethod http_request_get_method(const HttpRequest *req) {
     return req ? req->method : GET;
 }
 
 const char* http_request_get_route(const HttpRequest *req) {
-    return req ? req->route : NULL;
+    return req ? http_view_str(req, req->route) : NULL;
+}
+
+static int ascii_casecmp_n(const char* a, const char* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        int ca = tolower((unsigned char)a[i]);
+        int cb = tolower((unsigned char)b[i]);
+        if (ca != cb) return ca - cb;
+        if (!ca) return 0;
+    }
+    return 0;
+}
+
+// ======== 頭部索引 ========
+static const char* const g_known_headers[HTTP_HEADER_COUNT] = {
+    "Host",
+    "Connection",
+    "Content-Length",
+    "Content-Type",
+    "Content-Encoding",
+    "Transfer-Encoding",
+    "Expect",
+    "Upgrade",
+    "Accept",
+    "Accept-Encoding",
+    "Accept-Language",
+    "Authorization",
+    "Cookie",
+    "User-Agent",
+    "Referer",
+    "Origin",
+    "Cache-Control",
+    "Range",
+    "If-Range",
+    "If-Match",
+    "If-None-Match",
+    "If-Modified-Since",
+    "If-Unmodified-Since",
+    "X-Forwarded-For",
+};
+
+// (4 * 首字符 + 尾字符 + 長度) & 63 對上表中的名稱（小寫）沒有衝突；
+// 增刪常用頭部時需要重新選取係數並生成此表
+static const int8_t g_header_slots[64] = {
+     7, 14,  2,  4,  1, 16, -1, -1,  5, -1, -1, -1, -1, -1,  6, -1,
+    -1, 18, 13, -1, 19, -1, -1, -1,  0, 20, 21, -1, 22, -1, -1, -1,
+    -1, 23, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    15, -1, 17, -1, -1, -1, -1, 12, 10, -1,  9, -1, -1,  3,  8, 11,
+};
+
+static unsigned char ascii_lower(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+int http_header_lookup(const char* name, size_t len) {
+    if (len == 0) return -1;
+    unsigned h = (ascii_lower((unsigned char)name[0]) * 4u +
+                  ascii_lower((unsigned char)name[len - 1]) + (unsigned)len) & 63;
+    int id = g_header_slots[h];
+    if (id < 0) return -1;
+
+    const char* known = g_known_headers[id];
+    if (strlen(known) != len || ascii_casecmp_n(known, name, len) != 0) return -1;
+    return id;
+}
+
+uint32_t http_header_hash(const char* name, size_t len) {
+    uint32_t h = 2166136261u;   // FNV-1a
+    for (size_t i = 0; i < len; i++) {
+        h ^= ascii_lower((unsigned char)name[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+const char* http_request_get_known_header(const HttpRequest *req, HttpHeaderId id) {
+    if (!req || (unsigned)id >= HTTP_HEADER_COUNT || !req->known[id]) return NULL;
+    return http_view_str(req, req->headers[req->known[id] - 1].value);
 }
 
 const char* http_request_get_header(const HttpRequest *req, const char* key) {
     if (!req || !key) return NULL;
-    for (size_t i = 0; i < req->headers.count; i++) {
-        if (strcmp(req->headers.items[i].key, key) == 0)
-            return req->headers.items[i].value;
+
+    size_t klen = strlen(key);
+    int id = http_header_lookup(key, klen);
+    if (id >= 0) return http_request_get_known_header(req, (HttpHeaderId)id);
+
+    uint32_t hash = http_header_hash(key, klen);
+    for (size_t i = 0; i < req->header_count; i++) {
+        const HttpHeaderView* h = &req->headers[i];
+        if (h->hash == hash && h->key.len == klen &&
+            ascii_casecmp_n(http_view_str(req, h->key), key, klen) == 0)
+            return http_view_str(req, h->value);
     }
     return NULL;
 }
 
+// ======== 路徑與查詢參數 ========
+static int hex_value(unsigned char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = ascii_lower(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// s[i] 為 '%' 時，後面是否跟著兩位十六進制數
+static int valid_escape(const char* s, size_t len, size_t i) {
+    return i + 2 < len && hex_value((unsigned char)s[i + 1]) >= 0 &&
+           hex_value((unsigned char)s[i + 2]) >= 0;
+}
+
+static char decode_escape(const char* s) {
+    return (char)(hex_value((unsigned char)s[1]) << 4 | hex_value((unsigned char)s[2]));
+}
+
+int http_percent_decode(char* s, size_t len, int form, size_t* out_len) {
+    // 先整體校驗，失敗時 s 保持不變
+    for (const char* p = s; (p = memchr(p, '%', s + len - p)) != NULL; p++) {
+        if (!valid_escape(s, len, p - s) || decode_escape(p) == '\0') return -1;
+    }
+
+    size_t o = 0;
+    for (size_t i = 0; i < len; i++) {
+        char c = s[i];
+        if (c == '%') {
+            c = decode_escape(s + i);
+            i += 2;
+        } else if (form && c == '+') {
+            c = ' ';
+        }
+        s[o++] = c;
+    }
+    *out_len = o;
+    return 0;
+}
+
+typedef struct HttpQueryParam {
+    const char* key;        // 原始的鍵，比較時邊解碼邊比較
+    size_t key_len;
+    char* value;            // 以 '\0' 結尾，第一次被查到時就地解碼
+    size_t value_len;
+    int decoded;
+} HttpQueryParam;
+
+struct HttpQueryIndex {
+    size_t count;
+    HttpQueryParam* params;
+    char* buf;              // 查詢字符串的副本，原始查詢字符串保持不變
+};
+
+static struct HttpQueryIndex* query_index_build(const HttpRequest* req) {
+    const char* q = http_view_str(req, req->query);
+    size_t len = req->query.len;
+
+    // '&' 的個數加一是參數個數的上界，索引和副本一次分配
+    size_t cap = 1;
+    for (const char* p = q; (p = memchr(p, '&', q + len - p)) != NULL; p++) cap++;
+
+    struct HttpQueryIndex* idx = http_arena_alloc(req->arena, sizeof(struct HttpQueryIndex) +
+                                                  cap * sizeof(HttpQueryParam) + len + 1);
+    if (!idx) return NULL;
+    idx->count = 0;
+    idx->params = (HttpQueryParam*)(idx + 1);
+    idx->buf = (char*)(idx->params + cap);
+    memcpy(idx->buf, q, len);
+    idx->buf[len] = '\0';
+
+    char* p = idx->buf;
+    char* end = p + len;
+    for (;;) {
+        char* amp = memchr(p, '&', end - p);
+        char* seg_end = amp ? amp : end;
+        if (seg_end > p) {  // 跳過空段，如 "a=1&&b=2"
+            char* eq = memchr(p, '=', seg_end - p);
+            HttpQueryParam* prm = &idx->params[idx->count++];
+            prm->key = p;
+            prm->key_len = (eq ? eq : seg_end) - p;
+            prm->value = eq ? eq + 1 : seg_end;
+            prm->value_len = seg_end - prm->value;
+            prm->decoded = 0;
+            *seg_end = '\0';
+        }
+        if (!amp) break;
+        p = amp + 1;
+    }
+    return idx;
+}
+
+// 按 application/x-www-form-urlencoded 解碼 raw 的同時與 key 比較
+static int query_key_equals(const char* raw, size_t len, const char* key) {
+    for (size_t i = 0; i < len; i++, key++) {
+        char c = raw[i];
+        if (c == '+') {
+            c = ' ';
+        } else if (c == '%' && valid_escape(raw, len, i)) {
+            c = decode_escape(raw + i);
+            i += 2;
+        }
+        if (c == '\0' || *key != c) return 0;
+    }
+    return *key == '\0';
+}
+
+const char* http_request_get_param(const HttpRequest *req, const char* name) {
+    if (!req || !name) return NULL;
+    for (size_t i = 0; i < req->param_count; i++) {
+        if (strcmp(req->params[i].name, name) == 0)
+            return req->param_buf + req->params[i].value.off;
+    }
+    return NULL;
+}
+
+const char* http_request_get_query_string(const HttpRequest *req) {
+    return req && req->has_query ? http_view_str(req, req->query) : NULL;
+}
+
+const char* http_request_get_query(const HttpRequest *req, const char* key) {
+    if (!req || !key || !req->has_query) return NULL;
+
+    // 索引只是緩存，不改變請求的可見內容
+    HttpRequest* r = (HttpRequest*)req;
+    if (!r->query_index && !(r->query_index = query_index_build(r))) return NULL;
+
+    struct HttpQueryIndex* idx = r->query_index;
+    for (size_t i = 0; i < idx->count; i++) {
+        HttpQueryParam* prm = &idx->params[i];
+        if (!query_key_equals(prm->key, prm->key_len, key)) continue;
+
+        if (!prm->decoded) {
+            // 非法轉義保留原樣
+            size_t n;
+            if (http_percent_decode(prm->value, prm->value_len, 1, &n) == 0)
+                prm->value[n] = '\0';
+            prm->decoded = 1;
+        }
+        return prm->value;
+    }
+    return NULL;
+}
+
+int http_header_has_token(const char* value, const char* token) {
+    size_t tlen = strlen(token);
+    const char* p = value;
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        const char* start = p;
+        while (*p && *p != ',') p++;
+        const char* end = p;
+        while (end > start && (end[-1] == ' ' || end[-1] == '\t')) end--;
+        if ((size_t)(end - start) == tlen && ascii_casecmp_n(start, token, tlen) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+int http_request_is_http11(const HttpRequest* req) {
+    return req->version.len == 8 && memcmp(http_view_str(req, req->version), "HTTP/1.1", 8) == 0;
+}
+
+int http_request_keep_alive(const HttpRequest* req) {
+    if (!req) return 0;
+
+    const char* conn = http_request_get_known_header(req, HTTP_HEADER_CONNECTION);
+    if (conn) {
+        if (http_header_has_token(conn, "close")) return 0;
+        if (http_header_has_token(conn, "keep-alive")) return 1;
+    }
+    // HTTP/1.1 默認長連接，HTTP/1.0 默認短連接
+    return http_request_is_http11(req);
+}
+
 const char* http_request_get_body(const HttpRequest *req, size_t* length) {
     if (!req) return NULL;
     if (length) *length = req->content_length;
     return req->content;
 }
 
+void http_request_set_user_data(HttpRequest* req, void* data) {
+    if (req) req->user_data = data;
+}
+
+void* http_request_get_user_data(const HttpRequest* req) {
+    return req ? req->user_data : NULL;
+}
+
+void* http_request_arena_alloc(const HttpRequest* req, size_t size) {
+    return req ? http_arena_alloc(req->arena, size) : NULL;
+}
+
+// 請求的內存都屬於連接的 arena，不單獨釋放
 void free_request(HttpRequest* req) {
-    if (!req) return;
-    if (req->content) free(req->content);
-    free(req);
+    (void)req;
 }
\ No newline at end of file
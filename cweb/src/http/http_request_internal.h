@@ -1,17 +1,78 @@
 #ifndef HTTP_REQUEST_INTERNAL_H
 #define HTTP_REQUEST_INTERNAL_H
 
+#include "http/http_arena_internal.h"
 #include "http/http_internal.h"
 #include "http/http_request.h"
 
+#include <stdint.h>
+
+// 請求頭原文中的一段，相對 HttpRequest.head 的偏移和長度
+typedef struct HttpStrView {
+    uint32_t off;
+    uint32_t len;
+} HttpStrView;
+
+typedef struct HttpHeaderView {
+    HttpStrView key;
+    HttpStrView value;
+    int id;                 // HttpHeaderId，不是常用頭部時為 -1
+    uint32_t hash;          // 非常用頭部名稱的小寫哈希，查找時先比較哈希
+} HttpHeaderView;
+
+#define HTTP_MAX_ROUTE_PARAMS 8
+#define HTTP_ROUTE_PARAM_NAME_BYTES 128     // 一個路由中所有參數名（含 '\0'）的總長度上限
+
+// 路由模式中 ":name" 或 "*name" 捕獲的值；name 和 value 都在 HttpRequest.param_buf 中
+typedef struct HttpRouteParam {
+    const char* name;
+    HttpStrView value;
+} HttpRouteParam;
+
+// 請求、頭部索引和請求頭原文在同一塊內存中；各字段不單獨複製，
+// 而是在原文中就地以 '\0' 結尾，可直接作為 C 字符串使用。
+// 請求及其 body、查詢參數索引都分配在連接的 arena 中，不單獨釋放
 struct HttpRequest {
     HttpMethod method;
-    char route[256];
-    char version[64];
-    HeaderTable headers;
+    char* head;
+    HttpStrView route;      // 已解碼的路徑
+    HttpStrView query;      // 原始查詢字符串，has_query 為 0 時無效
+    int has_query;
+    HttpStrView version;
+    HttpHeaderView* headers;
+    size_t header_count;
+    uint16_t known[HTTP_HEADER_COUNT];  // 常用頭部在 headers 中的下標 + 1，0 表示沒有
     char* content;
     size_t content_length;
     time_t request_time;
+    void* user_data;        // 流式路由在各次回調間保存狀態
+    struct HttpQueryIndex* query_index;     // 首次查詢參數時建立
+    HttpRouteParam params[HTTP_MAX_ROUTE_PARAMS];
+    size_t param_count;
+    HttpArena* arena;
+    char* param_buf;        // 路徑的副本（各參數值在其中以 '\0' 結尾）和參數名；與請求同一塊內存
 };
 
+static inline const char* http_view_str(const HttpRequest* req, HttpStrView v) {
+    return req->head + v.off;
+}
+
+int http_request_is_http11(const HttpRequest* req);
+
+// 根據版本和 Connection 頭判斷客戶端是否希望保持連接
+int http_request_keep_alive(const HttpRequest* req);
+
+// 按名稱識別常用頭部（完美哈希，大小寫不敏感），不是常用頭部時返回 -1
+int http_header_lookup(const char* name, size_t len);
+
+// 就地解碼 s 中的 %XX，form 為真時同時把 '+' 解碼為空格（application/x-www-form-urlencoded）。
+// 遇到非法轉義或 %00 時返回 -1，否則返回 0，out_len 輸出解碼後的長度
+int http_percent_decode(char* s, size_t len, int form, size_t* out_len);
+
+// 頭部名稱的大小寫不敏感哈希
+uint32_t http_header_hash(const char* name, size_t len);
+
+// 在逗號分隔的頭部值中查找 token（大小寫不敏感）
+int http_header_has_token(const char* value, const char* token);
+
 #endif
\ No newline at end of file
@@ -1,7 +1,8 @@
 #include "http/http.h"
 #include "http/http_internal.h"
+#include "http/http_compress_internal.h"
 #include "http/http_response_internal.h"
-#include "utils/file/file.h"
+#include "http/http_static_internal.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -10,11 +11,23 @@
 
 void http_response_add_header(HttpResponse* res, const char* key, const char* value)
 {
-    if (!res || !key || !value || res->headers.count >= MAX_HEADER_SIZE) return;
+    if (!res || !key || !value) return;
+
+    HeaderTable* t = &res->headers;
+    if (t->count == t->cap) {
+        size_t cap = t->cap ? t->cap * 2 : HTTP_RESPONSE_HEADERS_INIT;
+        HttpHeader* items = http_arena_grow(res->arena, t->items, t->cap * sizeof(HttpHeader),
+                                            cap * sizeof(HttpHeader));
+        if (!items) return;
+        t->items = items;
+        t->cap = cap;
+    }
 
-    strncpy(res->headers.items[res->headers.count].key, key, 63);
-    strncpy(res->headers.items[res->headers.count].value, value, 255);
-    res->headers.count++;
+    HttpHeader* h = &t->items[t->count];
+    h->key = http_arena_strdup(res->arena, key);
+    h->value = http_arena_strdup(res->arena, value);
+    if (!h->key || !h->value) return;
+    t->count++;
 }
 void http_response_status_ok(HttpResponse* res)
 {
@@ -34,15 +47,22 @@ void http_response_status_error(HttpResponse* res)
     res->status = 500;
     res->status_text = "Internal Server Error";
 }
+void http_response_set_status(HttpResponse* res, int status, const char* status_text)
+{
+    if (!res) return;
+    res->status = status;
+    res->status_text = status_text;
+}
 void http_response_set_text(HttpResponse* res, const char* text)
 {
     if (!res || !text) return;
 
-    if (res->body) free(res->body);
-
     res->body_length = strlen(text);
-    res->body = malloc(res->body_length + 1); // 留出 '\0'
-    if (!res->body) return;
+    res->body = http_arena_alloc(res->arena, res->body_length + 1); // 留出 '\0'
+    if (!res->body) {
+        res->body_length = 0;
+        return;
+    }
 
     memcpy(res->body, text, res->body_length);
     res->body[res->body_length] = '\0'; // 终止符
@@ -53,10 +73,11 @@ void http_response_set_text_len(HttpResponse* res, const char* text, size_t len)
 {
     if (!res || !text) return;
 
-    if (res->body) free(res->body);
-
-    res->body = malloc(len + 1);
-    if (!res->body) return;
+    res->body = http_arena_alloc(res->arena, len + 1);
+    if (!res->body) {
+        res->body_length = 0;
+        return;
+    }
 
     memcpy(res->body, text, len);
     res->body[len] = '\0'; // 保证终止符
@@ -73,9 +94,11 @@ void http_response_set_json(HttpResponse* res, const char* json, ...)
     int len = vsnprintf(NULL, 0, json, args);
     va_end(args);
 
-    if (res->body) free(res->body);
-    res->body = malloc(len + 1); // 多分配一个字节给 '\0'
-    if (!res->body) return;
+    res->body = http_arena_alloc(res->arena, len + 1); // 多分配一个字节给 '\0'
+    if (!res->body) {
+        res->body_length = 0;
+        return;
+    }
 
     va_start(args, json);
     vsnprintf(res->body, len + 1, json, args); // 写入 '\0'
@@ -88,93 +111,714 @@ void http_response_set_file(HttpResponse* res, const char* filepath)
 {
     if (!res || !filepath) return;
 
-    res->file_path = strdup(filepath);
+    res->file_path = http_arena_strdup(res->arena, filepath);
 }
 
-void free_response(HttpResponse* res) {
-    if (!res) return;
+static int stream_append(HttpResponse* res, const void* data, size_t len)
+{
+    if (res->stream_cap - res->stream_len < len) {
+        size_t cap = res->stream_cap ? res->stream_cap : 4096;
+        while (cap - res->stream_len < len) cap *= 2;
+        char* nb = realloc(res->stream_buf, cap);
+        if (!nb) return -1;
+        res->stream_buf = nb;
+        res->stream_cap = cap;
+    }
+    memcpy(res->stream_buf + res->stream_len, data, len);
+    res->stream_len += len;
+    return 0;
+}
+void http_response_begin_stream(HttpResponse* res, HttpStreamProducer producer, void* ctx)
+{
+    if (!res || !producer || res->stream) return;
 
-    if (res->body) {
-        free(res->body);
+    res->stream = producer;
+    res->stream_ctx = ctx;
+    // 不支持 chunked 的客戶端以關閉連接標誌 body 結束
+    if (!res->chunked_ok) res->keep_alive = 0;
+}
+int http_response_write_chunk(HttpResponse* res, const void* data, size_t len)
+{
+    if (!res || !res->stream || res->stream_ended) return -1;
+    if (len == 0) return 0;     // 空 chunk 表示結束，不能直接寫出
+    if (!res->chunked_ok) return stream_append(res, data, len);
+
+    char size_line[32];
+    int n = snprintf(size_line, sizeof(size_line), "%zx\r\n", len);
+    if (stream_append(res, size_line, (size_t)n) != 0 ||
+        stream_append(res, data, len) != 0 ||
+        stream_append(res, "\r\n", 2) != 0)
+        return -1;
+    return 0;
+}
+void http_response_end(HttpResponse* res)
+{
+    if (!res || !res->stream || res->stream_ended) return;
+
+    res->stream_ended = 1;
+    if (res->chunked_ok)
+        stream_append(res, "0\r\n\r\n", 5);
+}
+
+HttpResponse* http_response_create(HttpArena* arena) {
+    HttpResponse* res = http_arena_alloc(arena, sizeof(HttpResponse));
+    if (!res) return NULL;
+    memset(res, 0, sizeof(HttpResponse));
+    res->arena = arena;
+    return res;
+}
+
+// 關閉響應自己打開的文件並釋放緩存引用；緩存中的句柄隨引用一起釋放，不能在這裡關閉
+static void release_file(HttpResponse* res) {
+    if (res->file) {
+        if (!res->cached || res->file != res->cached->file) file_close(res->file);
+        res->file = NULL;
+    }
+    if (res->cached) {
+        http_file_cache_release(res->cached);
+        res->cached = NULL;
         res->body = NULL;
         res->body_length = 0;
     }
+}
 
-    if (res->file_path) {
-        free(res->file_path);
-        res->file_path = NULL;
+// body 和 file_path 屬於 arena，這裡只釋放流式緩衝區、打開的文件和緩存引用
+void free_response(HttpResponse* res) {
+    if (!res) return;
+
+    if (res->stream) {
+        res->stream(NULL, res->stream_ctx);
+        free(res->stream_buf);
+        res->stream = NULL;
     }
 
-    free(res);
+    release_file(res);
 }
 
-char* build_http_response(HttpResponse* res, size_t* out_len) {
-    if (!res) return NULL;
+// ======== 響應頭的固定部分 ========
+typedef struct StatusLine {
+    const char* text;
+    const char* line;       // 序列化好的 "HTTP/1.1 <code> <text>\r\n"
+    size_t len;
+} StatusLine;
+
+#define STATUS_LINE(code, text) \
+    [code - 100] = { text, "HTTP/1.1 " #code " " text "\r\n", sizeof("HTTP/1.1 " #code " " text "\r\n") - 1 }
+
+static const StatusLine g_status_lines[500] = {
+    STATUS_LINE(100, "Continue"),
+    STATUS_LINE(101, "Switching Protocols"),
+    STATUS_LINE(200, "OK"),
+    STATUS_LINE(201, "Created"),
+    STATUS_LINE(202, "Accepted"),
+    STATUS_LINE(204, "No Content"),
+    STATUS_LINE(206, "Partial Content"),
+    STATUS_LINE(301, "Moved Permanently"),
+    STATUS_LINE(302, "Found"),
+    STATUS_LINE(303, "See Other"),
+    STATUS_LINE(304, "Not Modified"),
+    STATUS_LINE(307, "Temporary Redirect"),
+    STATUS_LINE(308, "Permanent Redirect"),
+    STATUS_LINE(400, "Bad Request"),
+    STATUS_LINE(401, "Unauthorized"),
+    STATUS_LINE(403, "Forbidden"),
+    STATUS_LINE(404, "Not Found"),
+    STATUS_LINE(405, "Method Not Allowed"),
+    STATUS_LINE(406, "Not Acceptable"),
+    STATUS_LINE(408, "Request Timeout"),
+    STATUS_LINE(409, "Conflict"),
+    STATUS_LINE(410, "Gone"),
+    STATUS_LINE(411, "Length Required"),
+    STATUS_LINE(412, "Precondition Failed"),
+    STATUS_LINE(413, "Payload Too Large"),
+    STATUS_LINE(414, "URI Too Long"),
+    STATUS_LINE(415, "Unsupported Media Type"),
+    STATUS_LINE(416, "Range Not Satisfiable"),
+    STATUS_LINE(417, "Expectation Failed"),
+    STATUS_LINE(426, "Upgrade Required"),
+    STATUS_LINE(429, "Too Many Requests"),
+    STATUS_LINE(431, "Request Header Fields Too Large"),
+    STATUS_LINE(500, "Internal Server Error"),
+    STATUS_LINE(501, "Not Implemented"),
+    STATUS_LINE(502, "Bad Gateway"),
+    STATUS_LINE(503, "Service Unavailable"),
+    STATUS_LINE(504, "Gateway Timeout"),
+    STATUS_LINE(505, "HTTP Version Not Supported"),
+};
+
+static const StatusLine* find_status_line(int status) {
+    if (status < 100 || status >= 600 || !g_status_lines[status - 100].line) return NULL;
+    return &g_status_lines[status - 100];
+}
 
-    const char* http_version = "HTTP/1.1";
-    char header_buf[1024];
-    int pos = 0;
-
-    char* body_buf = res->body;
-    size_t body_len = res->body_length;
-    int body_buf_allocated = 0; // 是否需要 free
-
-    // --------- 处理文件 ---------
-    if (res->file_path) {
-        char* file_buf = file_read_all(res->file_path, &body_len);
-        if (!file_buf) {
-            // 文件读取失败，返回 404
-            res->status = 404;
-            res->status_text = "Not Found";
-            body_buf = (char*)"File not found"; // 静态字符串
-            body_len = strlen(body_buf);
+const char* http_status_text(int status) {
+    const StatusLine* sl = find_status_line(status);
+    return sl ? sl->text : "";
+}
+
+static const char g_weekdays[7][4] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+static const char g_months[12][4] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+};
+
+static void put2(char* p, int v) {
+    p[0] = (char)('0' + v / 10);
+    p[1] = (char)('0' + v % 10);
+}
+
+size_t http_format_date(time_t t, char* out) {
+    // 由天數推算公曆日期，不依賴 gmtime 的綫程安全版本
+    int64_t secs = (int64_t)t;
+    int64_t days = secs / 86400;
+    int64_t rem = secs % 86400;
+    if (rem < 0) {
+        rem += 86400;
+        days--;
+    }
+    int wday = (int)((days % 7 + 11) % 7);  // 1970-01-01 是星期四
+
+    int64_t z = days + 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    int mday = (int)(doy - (153 * mp + 2) / 5 + 1);
+    int mon = (int)(mp < 10 ? mp + 3 : mp - 9);
+    int64_t year = yoe + era * 400 + (mon <= 2);
+
+    // "Sun, 06 Nov 1994 08:49:37 GMT"
+    memcpy(out, g_weekdays[wday], 3);
+    out[3] = ',';
+    out[4] = ' ';
+    put2(out + 5, mday);
+    out[7] = ' ';
+    memcpy(out + 8, g_months[mon - 1], 3);
+    out[11] = ' ';
+    put2(out + 12, (int)(year / 100 % 100));
+    put2(out + 14, (int)(year % 100));
+    out[16] = ' ';
+    put2(out + 17, (int)(rem / 3600));
+    out[19] = ':';
+    put2(out + 20, (int)(rem / 60 % 60));
+    out[22] = ':';
+    put2(out + 23, (int)(rem % 60));
+    memcpy(out + 25, " GMT", 5);
+    return HTTP_DATE_LEN;
+}
+
+static int parse_digits(const char* s, int n) {
+    int v = 0;
+    for (int i = 0; i < n; i++) {
+        if (s[i] < '0' || s[i] > '9') return -1;
+        v = v * 10 + (s[i] - '0');
+    }
+    return v;
+}
+
+int http_parse_date(const char* s, time_t* out) {
+    // 只接受 IMF-fixdate；過時的 RFC 850 和 asctime 格式按無效處理，條件不成立
+    if (!s || strlen(s) != HTTP_DATE_LEN || s[3] != ',' || s[4] != ' ' || s[7] != ' ' ||
+        s[11] != ' ' || s[16] != ' ' || s[19] != ':' || s[22] != ':' || memcmp(s + 25, " GMT", 4) != 0)
+        return -1;
+
+    int mon = 0;
+    while (mon < 12 && memcmp(s + 8, g_months[mon], 3) != 0) mon++;
+    int mday = parse_digits(s + 5, 2);
+    int year = parse_digits(s + 12, 4);
+    int hour = parse_digits(s + 17, 2);
+    int min = parse_digits(s + 20, 2);
+    int sec = parse_digits(s + 23, 2);
+    if (mon == 12 || mday < 1 || mday > 31 || year < 0 || hour < 0 || hour > 23 ||
+        min < 0 || min > 59 || sec < 0 || sec > 60)
+        return -1;
+
+    // http_format_date 的逆運算
+    int64_t y = year - (mon < 2);
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t mp = mon < 2 ? mon + 10 : mon - 2;
+    int64_t doy = (153 * mp + 2) / 5 + mday - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = era * 146097 + doe - 719468;
+    *out = (time_t)(days * 86400 + hour * 3600 + min * 60 + sec);
+    return 0;
+}
+
+// 每個綫程緩存當前秒的 "Date: ...\r\n"，秒數變化時才重新格式化
+static const char* cached_date_line(void) {
+    static _Thread_local time_t t_sec = (time_t)-1;
+    static _Thread_local char t_line[sizeof("Date: \r\n") + HTTP_DATE_LEN];
+    time_t now = time(NULL);
+    if (now != t_sec) {
+        memcpy(t_line, "Date: ", 6);
+        http_format_date(now, t_line + 6);
+        memcpy(t_line + 6 + HTTP_DATE_LEN, "\r\n", 3);
+        t_sec = now;
+    }
+    return t_line;
+}
+
+// 十進制寫入 out，返回長度；out 至少 20 字節
+static size_t format_u64(char* out, uint64_t v) {
+    char tmp[20];
+    size_t n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    for (size_t i = 0; i < n; i++) out[i] = tmp[n - 1 - i];
+    return n;
+}
+
+static int head_append(char* buf, size_t cap, size_t* pos, const char* s, size_t len)
+{
+    if (len > cap - *pos) return -1;
+    memcpy(buf + *pos, s, len);
+    *pos += len;
+    return 0;
+}
+
+#define HEAD_APPEND_LIT(buf, cap, pos, lit) head_append(buf, cap, pos, lit, sizeof(lit) - 1)
+
+// 按名稱查找響應頭，不區分大小寫；不存在時返回 -1
+static int header_index(const HttpResponse* res, const char* key)
+{
+    for (size_t i = 0; i < res->headers.count; i++) {
+        const char* k = res->headers.items[i].key;
+        size_t j = 0;
+        while (key[j] && ((k[j] | 0x20) == (key[j] | 0x20))) j++;
+        if (!key[j] && !k[j]) return (int)i;
+    }
+    return -1;
+}
+
+static const char* find_header(const HttpResponse* res, const char* key)
+{
+    int i = header_index(res, key);
+    return i < 0 ? NULL : res->headers.items[i].value;
+}
+
+// 替換已有的響應頭，不存在時添加
+static void set_header(HttpResponse* res, const char* key, const char* value)
+{
+    int i = header_index(res, key);
+    if (i < 0) {
+        http_response_add_header(res, key, value);
+        return;
+    }
+    const char* copy = http_arena_strdup(res->arena, value);
+    if (copy) res->headers.items[i].value = copy;
+}
+
+static int has_header(const HttpResponse* res, const char* key)
+{
+    return find_header(res, key) != NULL;
+}
+
+static int head_printf(char* buf, size_t cap, size_t* pos, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + *pos, cap - *pos, fmt, args);
+    va_end(args);
+
+    if (n < 0 || (size_t)n >= cap - *pos) return -1;
+    *pos += n;
+    return 0;
+}
+
+// If-None-Match 的列表中有與 etag 弱比較相等的項，或為 "*"
+static int etag_matches(const char* list, const char* etag) {
+    size_t etag_len = strlen(etag);
+    const char* p = list;
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        if (!*p) break;
+        if (*p == '*') return 1;
+        if (p[0] == 'W' && p[1] == '/') p += 2;
+
+        const char* end = p;
+        if (*end == '"') {
+            end = strchr(end + 1, '"');
+            if (!end) return 0;
+            end++;
+        }
+        while (*end && *end != ',') end++;
+
+        size_t len = (size_t)(end - p);
+        while (len > 0 && (p[len - 1] == ' ' || p[len - 1] == '\t')) len--;
+        if (len == etag_len && memcmp(p, etag, len) == 0) return 1;
+        p = end;
+    }
+    return 0;
+}
+
+// RFC 7232：有 If-None-Match 時忽略 If-Modified-Since
+static int not_modified(const HttpResponse* res, const HttpFileValidators* v) {
+    if (res->if_none_match) return etag_matches(res->if_none_match, v->etag);
+    time_t since;
+    if (res->if_modified_since && http_parse_date(res->if_modified_since, &since) == 0)
+        return v->mtime <= since;
+    return 0;
+}
+
+// ======== Range ========
+typedef struct ByteRange {
+    uint64_t first;
+    uint64_t last;
+} ByteRange;
+
+static const char* parse_u64(const char* p, uint64_t* out) {
+    if (*p < '0' || *p > '9') return NULL;
+    uint64_t v = 0;
+    for (; *p >= '0' && *p <= '9'; p++) {
+        unsigned d = (unsigned)(*p - '0');
+        if (v > (UINT64_MAX - d) / 10) return NULL;
+        v = v * 10 + d;
+    }
+    *out = v;
+    return p;
+}
+
+// 解析 "bytes=0-99, 200-, -50"，越過文件末尾的區間截斷，完全在文件之外的丟棄。
+// 返回可滿足的區間數；語法錯誤、單位不是 bytes 或區間超過 max 時返回 -1，按沒有 Range 處理
+static int parse_ranges(const char* s, uint64_t size, ByteRange* out, int max) {
+    if (strncmp(s, "bytes=", 6) != 0) return -1;
+
+    const char* p = s + 6;
+    int seen = 0, n = 0;
+    for (;;) {
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        if (!*p) break;
+        if (++seen > max) return -1;
+
+        uint64_t first, last;
+        int ok;
+        if (*p == '-') {
+            // 最後 N 個字節
+            uint64_t suffix;
+            if (!(p = parse_u64(p + 1, &suffix))) return -1;
+            ok = suffix > 0 && size > 0;
+            first = suffix >= size ? 0 : size - suffix;
+            last = size - 1;
         } else {
-            body_buf = file_buf;
-            body_buf_allocated = 1;  // 需要释放
-            // 自动添加 Content-Type
-            http_response_add_header(res, "Content-Type", "text/html; charset=utf-8");
+            if (!(p = parse_u64(p, &first)) || *p != '-') return -1;
+            p++;
+            last = UINT64_MAX;
+            if (*p >= '0' && *p <= '9') {
+                if (!(p = parse_u64(p, &last)) || last < first) return -1;
+            }
+            ok = first < size;
+            if (ok && last >= size) last = size - 1;
         }
+        if (ok) out[n++] = (ByteRange){ first, last };
+
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p && *p != ',') return -1;
     }
+    return seen > 0 ? n : -1;
+}
 
-    // --------- 构建 HTTP 头 ---------
-    pos += snprintf(header_buf + pos, sizeof(header_buf) - pos,
-                    "%s %d %s\r\n",
-                    http_version,
-                    res->status,
-                    res->status_text ? res->status_text : "");
+// If-Range 是 ETag 時要求強比較相等，是日期時要求與 Last-Modified 完全相同
+static int if_range_matches(const char* if_range, const HttpFileValidators* v) {
+    if (!if_range) return 1;
+    if (if_range[0] == '"') return strcmp(if_range, v->etag) == 0;
+    time_t t;
+    return http_parse_date(if_range, &t) == 0 && t == v->mtime;
+}
 
-    // 自定义 Header
-    for (size_t i = 0; i < res->headers.count; i++) {
-        pos += snprintf(header_buf + pos, sizeof(header_buf) - pos,
-                        "%s: %s\r\n",
-                        res->headers.items[i].key,
-                        res->headers.items[i].value);
+static void drop_file_body(HttpResponse* res) {
+    release_file(res);
+    res->body = NULL;
+    res->body_length = 0;
+}
+
+static void set_part(HttpBodyPart* part, const char* base, uint64_t off, uint64_t len) {
+    part->data = base ? base + off : NULL;
+    part->off = off;
+    part->len = len;
+}
+
+// 按 Range 只發送請求的區間：一個區間時回覆 206 和 Content-Range，多個時回覆 multipart/byteranges。
+// 返回響應應使用的 Content-Type；Range 被忽略時原樣返回 type
+static const char* apply_ranges(HttpResponse* res, uint64_t size, const char* type) {
+    ByteRange ranges[HTTP_MAX_RANGES];
+    int n = parse_ranges(res->range, size, ranges, HTTP_MAX_RANGES);
+    if (n < 0) return type;
+
+    char value[80];
+    if (n == 0) {
+        drop_file_body(res);
+        http_response_set_status(res, 416, "Range Not Satisfiable");
+        snprintf(value, sizeof(value), "bytes */%llu", (unsigned long long)size);
+        http_response_add_header(res, "Content-Range", value);
+        return type;
     }
 
-    // Content-Length 和 Connection
-    pos += snprintf(header_buf + pos, sizeof(header_buf) - pos,
-                    "Content-Length: %zu\r\n"
-                    "Connection: close\r\n"
-                    "\r\n",
-                    body_len);
+    const char* base = res->file ? NULL : res->body;
+    if (n == 1) {
+        HttpBodyPart* part = http_arena_alloc(res->arena, sizeof(HttpBodyPart));
+        if (!part) return type;
+        uint64_t len = ranges[0].last - ranges[0].first + 1;
+        set_part(part, base, ranges[0].first, len);
+        res->parts = part;
+        res->part_count = 1;
+        res->parts_length = len;
+
+        http_response_set_status(res, 206, "Partial Content");
+        snprintf(value, sizeof(value), "bytes %llu-%llu/%llu", (unsigned long long)ranges[0].first,
+                 (unsigned long long)ranges[0].last, (unsigned long long)size);
+        http_response_add_header(res, "Content-Range", value);
+        return type;
+    }
 
-    // --------- 分配完整缓冲区 ---------
-    size_t total_len = pos + body_len;
-    char* buffer = malloc(total_len);
-    if (!buffer) {
-        if (body_buf_allocated) free(body_buf);
-        return NULL;
+    // 每個區間前一段分隔頭，最後一段結束分隔符
+    HttpBodyPart* parts = http_arena_alloc(res->arena, sizeof(HttpBodyPart) * (2 * (size_t)n + 1));
+    if (!parts) return type;
+
+    static _Thread_local uint64_t t_seq;
+    char boundary[40];
+    snprintf(boundary, sizeof(boundary), "cweb%016llx%04llx",
+             (unsigned long long)time_now_ms(), (unsigned long long)(t_seq++ & 0xffff));
+
+    uint64_t total = 0;
+    size_t k = 0;
+    for (int i = 0; i < n; i++) {
+        int len = snprintf(value, sizeof(value), "bytes %llu-%llu/%llu", (unsigned long long)ranges[i].first,
+                           (unsigned long long)ranges[i].last, (unsigned long long)size);
+        size_t cap = strlen(boundary) + strlen(type) + (size_t)len + 64;
+        char* head = http_arena_alloc(res->arena, cap);
+        if (!head) return type;
+        int head_len = snprintf(head, cap, "%s--%s\r\nContent-Type: %s\r\nContent-Range: %s\r\n\r\n",
+                                i == 0 ? "" : "\r\n", boundary, type, value);
+        set_part(&parts[k++], head, 0, (uint64_t)head_len);
+
+        uint64_t data_len = ranges[i].last - ranges[i].first + 1;
+        set_part(&parts[k++], base, ranges[i].first, data_len);
+        total += (uint64_t)head_len + data_len;
     }
 
-    memcpy(buffer, header_buf, pos);
-    if (body_len > 0 && body_buf) {
-        memcpy(buffer + pos, body_buf, body_len);
+    char* tail = http_arena_alloc(res->arena, strlen(boundary) + 9);
+    if (!tail) return type;
+    int tail_len = sprintf(tail, "\r\n--%s--\r\n", boundary);
+    set_part(&parts[k++], tail, 0, (uint64_t)tail_len);
+    total += (uint64_t)tail_len;
+
+    res->parts = parts;
+    res->part_count = k;
+    res->parts_length = total;
+    http_response_set_status(res, 206, "Partial Content");
+
+    char* ct = http_arena_alloc(res->arena, strlen(boundary) + 32);
+    if (!ct) return type;
+    sprintf(ct, "multipart/byteranges; boundary=%s", boundary);
+    return ct;
+}
+
+// ======== 壓縮 ========
+// 客戶端接受時優先發送的預壓縮旁路文件，如 app.js.br、app.js.gz
+static const struct {
+    const char* coding;
+    const char* ext;
+} g_sidecars[] = {
+    { "br", ".br" },
+    { "gzip", ".gz" },
+};
+
+// 旁路文件存在時返回其路徑，能緩存時順帶取得緩存條目。
+// 不存在的結果也會被緩存，熱點文件沒有旁路文件時同樣不需要 stat
+static const char* find_sidecar(HttpResponse* res, const char** coding) {
+    if (!res->accept_encoding) return NULL;
+
+    size_t len = strlen(res->file_path);
+    for (size_t i = 0; i < sizeof(g_sidecars) / sizeof(g_sidecars[0]); i++) {
+        if (!http_accepts_encoding(res->accept_encoding, g_sidecars[i].coding)) continue;
+
+        char* path = http_arena_alloc(res->arena, len + 4);
+        if (!path) return NULL;
+        memcpy(path, res->file_path, len);
+        memcpy(path + len, g_sidecars[i].ext, 4);
+
+        int missing = 0;
+        res->cached = http_file_cache_get(path, &missing);
+        if (res->cached || (!missing && file_stat(path, NULL, NULL) == 0)) {
+            *coding = g_sidecars[i].coding;
+            return path;
+        }
     }
+    return NULL;
+}
 
-    if (out_len) *out_len = total_len;
+// 在 ETag 的結尾引號前加上後綴，區分同一文件的不同編碼
+static void etag_with_suffix(HttpFileValidators* v, const char* suffix) {
+    size_t len = strlen(v->etag);
+    size_t add = strlen(suffix);
+    if (len < 2 || len + add >= sizeof(v->etag)) return;
+    memcpy(v->etag + len - 1, suffix, add);
+    v->etag[len - 1 + add] = '"';
+    v->etag[len + add] = '\0';
+}
+
+// 動態生成的文本 body 超過閾值且客戶端接受 gzip 時，壓縮後發送
+static void compress_body(HttpResponse* res) {
+    if (!http_gzip_enabled() || !res->body || res->body_length < http_gzip_min_size() ||
+        res->status < 200 || res->status == 204 || res->status == 206 || res->status == 304 ||
+        find_header(res, "Content-Encoding") || !http_compressible_type(find_header(res, "Content-Type")))
+        return;
+
+    http_response_add_header(res, "Vary", "Accept-Encoding");
+    if (!http_accepts_encoding(res->accept_encoding, "gzip")) return;
+
+    // 結果必須比原數據小，輸出空間不需要超過原長度
+    char* out = http_arena_alloc(res->arena, res->body_length);
+    if (!out) return;
+    size_t n = http_gzip(res->body, res->body_length, out, res->body_length);
+    if (n == 0) return;
+
+    res->body = out;
+    res->body_length = n;
+    http_response_add_header(res, "Content-Encoding", "gzip");
+}
 
-    // 释放 file_read_all 分配的内存
-    if (body_buf_allocated) free(body_buf);
+// ======== 文件響應 ========
+// 準備文件響應：選擇旁路文件、緩存的壓縮結果或原文件；未變化時回覆 304，緩存命中時不做文件系統調用；
+// 否則從緩存發送或打開文件。文件不存在時返回 -1
+static int prepare_file(HttpResponse* res) {
+    // 處理函數沒有指定時按擴展名推斷 Content-Type
+    const char* type = find_header(res, "Content-Type");
+    int add_type = !type;
+    if (!type) type = http_mime_type(res->file_path);
+    const char* coding = NULL;
+    const char* path = find_sidecar(res, &coding);
+    if (!path) path = res->file_path;
+
+    // 校驗器必須描述實際發送的內容：緩存條目的校驗器在讀入或打開時由 fstat 得到；
+    // 不能緩存時先打開文件，再從同一個句柄取得大小和修改時間，
+    // 避免文件在 stat 和 open 之間被替換時，200、304 或 If-Range 依據的是另一個文件
+    HttpFileValidators v;
+    uint64_t size;
+    if (!res->cached) res->cached = http_file_cache_get(path, NULL);
+    if (res->cached) {
+        v = res->cached->validators;
+        size = res->cached->size;
+    } else {
+        int64_t mtime;
+        res->file = file_open_read(path, &res->file_size);
+        if (!res->file) return -1;
+        if (file_fstat(res->file, &size, &mtime) != 0) {
+            release_file(res);
+            return -1;
+        }
+        res->file_size = size;
+        http_file_validators(size, mtime, &v);
+    }
+
+    // 沒有旁路文件時，緩存中的文本文件壓縮一次，結果與緩存條目一起保存
+    const HttpCachedGzip* gz = NULL;
+    if (!coding && res->cached && http_gzip_enabled() && size >= http_gzip_min_size() &&
+        http_compressible_type(type) && http_accepts_encoding(res->accept_encoding, "gzip")) {
+        gz = http_file_cache_gzip(res->cached);
+        if (gz) etag_with_suffix(&v, "-gz");
+    }
+
+    if (res->status == 200 && not_modified(res, &v)) {
+        release_file(res);
+        http_response_set_status(res, 304, "Not Modified");
+        http_response_add_header(res, "ETag", v.etag);
+        http_response_add_header(res, "Last-Modified", v.last_modified);
+        http_response_add_header(res, "Vary", "Accept-Encoding");
+        return 0;
+    }
+
+    if (gz) {
+        res->body = (char*)gz->data;
+        res->body_length = gz->size;
+        size = gz->size;
+        coding = "gzip";
+    } else if (res->cached && res->cached->file) {
+        // 大文件共用緩存中打開的句柄，sendfile 按偏移發送，不影響其他響應
+        res->file = res->cached->file;
+        res->file_size = size;
+    } else if (res->cached) {
+        res->body = (char*)res->cached->data;
+        res->body_length = (size_t)size;
+    }
+
+    // Range 針對編碼後的內容；多個區間時 Content-Type 換成 multipart/byteranges
+    if (res->status == 200 && res->range && if_range_matches(res->if_range, &v)) {
+        const char* ranged = apply_ranges(res, size, type);
+        if (ranged != type && !add_type) set_header(res, "Content-Type", ranged);
+        type = ranged;
+    }
+
+    if (add_type) http_response_add_header(res, "Content-Type", type);
+    if (coding) http_response_add_header(res, "Content-Encoding", coding);
+    http_response_add_header(res, "Vary", "Accept-Encoding");
+    http_response_add_header(res, "Accept-Ranges", "bytes");
+    http_response_add_header(res, "ETag", v.etag);
+    http_response_add_header(res, "Last-Modified", v.last_modified);
+    return 0;
+}
 
-    return buffer;
-}
\ No newline at end of file
+size_t build_http_response(HttpResponse* res, char* buf, size_t cap) {
+    if (!res || !buf || cap == 0) return 0;
+
+    const char* http_version = "HTTP/1.1";
+    size_t pos = 0;
+
+    // --------- 处理文件：小文件從緩存發送，其餘只打开，不读入内存 ---------
+    if (res->file_path && !res->file && !res->cached && prepare_file(res) != 0) {
+        // 文件打开失败，返回 404
+        http_response_status_not_found(res);
+        http_response_set_text(res, "File not found");
+    } else if (!res->file_path && !res->stream) {
+        compress_body(res);
+    }
+
+    uint64_t body_len = res->parts ? res->parts_length : res->file ? res->file_size : res->body_length;
+
+    // --------- 构建 HTTP 头 ---------
+    // 標準狀態碼直接複製預先序列化的狀態行
+    const StatusLine* sl = find_status_line(res->status);
+    if (sl && (!res->status_text || strcmp(res->status_text, sl->text) == 0)) {
+        if (head_append(buf, cap, &pos, sl->line, sl->len) != 0) return 0;
+    } else if (head_printf(buf, cap, &pos, "%s %d %s\r\n",
+                           http_version,
+                           res->status,
+                           res->status_text ? res->status_text : "") != 0) {
+        return 0;
+    }
+
+    if (!has_header(res, "Date") &&
+        head_append(buf, cap, &pos, cached_date_line(), sizeof("Date: \r\n") - 1 + HTTP_DATE_LEN) != 0)
+        return 0;
+
+    // 自定義 Header
+    for (size_t i = 0; i < res->headers.count; i++) {
+        const HttpHeader* h = &res->headers.items[i];
+        if (head_append(buf, cap, &pos, h->key, strlen(h->key)) != 0 ||
+            HEAD_APPEND_LIT(buf, cap, &pos, ": ") != 0 ||
+            head_append(buf, cap, &pos, h->value, strlen(h->value)) != 0 ||
+            HEAD_APPEND_LIT(buf, cap, &pos, "\r\n") != 0)
+            return 0;
+    }
+
+    // Content-Length 或 chunked 編碼
+    if (res->stream) {
+        if (res->chunked_ok && HEAD_APPEND_LIT(buf, cap, &pos, "Transfer-Encoding: chunked\r\n") != 0)
+            return 0;
+    } else if (res->status != 304) {   // 304 沒有 body，也不重複實體的長度
+        char num[20];
+        if (HEAD_APPEND_LIT(buf, cap, &pos, "Content-Length: ") != 0 ||
+            head_append(buf, cap, &pos, num, format_u64(num, body_len)) != 0 ||
+            HEAD_APPEND_LIT(buf, cap, &pos, "\r\n") != 0)
+            return 0;
+    }
+
+    int r = res->keep_alive ? HEAD_APPEND_LIT(buf, cap, &pos, "Connection: keep-alive\r\n\r\n")
+                            : HEAD_APPEND_LIT(buf, cap, &pos, "Connection: close\r\n\r\n");
+    if (r != 0) return 0;
+
+    return pos;
+}
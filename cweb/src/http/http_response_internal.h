@@ -1,20 +1,78 @@
 #ifndef HTTP_RESPONSE_INTERNAL_H
 #define HTTP_RESPONSE_INTERNAL_H
 
+#include "http/http_arena_internal.h"
+#include "http/http_file_cache_internal.h"
 #include "http/http_internal.h"
 #include "http/http_response.h"
 
 #include <time.h>
 
+#define HTTP_MAX_RANGES 16      // 單個請求最多的區間數，超過時忽略 Range 發送整個文件
+
+// 響應 body 的一個片段：data 非空時為內存數據，否則為 file 中從 off 開始的區間
+typedef struct HttpBodyPart {
+    const char* data;
+    uint64_t off;
+    uint64_t len;
+} HttpBodyPart;
+
+// 響應和 body、file_path 分配在請求所屬的 arena 中，只有流式緩衝區單獨分配
 struct HttpResponse {
+    HttpArena* arena;
     int status;
     const char *status_text;
     char *body;
     size_t body_length;
     HeaderTable headers;
     char* file_path;
+    FileHandle* file;       // 文件響應打開後的句柄，body 由 sendfile 發送
+    uint64_t file_size;
+    const HttpCachedFile* cached;   // 文件響應命中緩存時 body 指向緩存內容，響應釋放時歸還
+    // GET 請求的條件頭部和 Range，文件未變化時回覆 304，只請求部分時回覆 206
+    const char* if_none_match;
+    const char* if_modified_since;
+    const char* range;
+    const char* if_range;
+    const char* accept_encoding;
+
+    // Range 請求：按順序發送這些片段代替整個 body 或文件，分配在 arena 中
+    HttpBodyPart* parts;
+    size_t part_count;
+    uint64_t parts_length;
+
+    int keep_alive;
+    int chunked_ok;         // 客戶端支持 chunked 編碼（HTTP/1.1）
+
+    // 流式響應：已編碼、待發送的數據暫存在 stream_buf
+    HttpStreamProducer stream;
+    void* stream_ctx;
+    char* stream_buf;
+    size_t stream_len;
+    size_t stream_cap;
+    size_t stream_sent;
+    int stream_ended;
 };
 
-char* build_http_response(HttpResponse* res, size_t* out_len);
+void http_response_set_status(HttpResponse* res, int status, const char* status_text);
+
+// 把狀態行和頭部寫入 buf，返回寫入的長度，空間不足時返回 0
+// body 不會被拷貝，由寫出方直接引用 res->body 或 res->file
+size_t build_http_response(HttpResponse* res, char* buf, size_t cap);
+
+#define HTTP_DATE_LEN 29
+
+// 按 RFC 7231 的 IMF-fixdate 格式化，如 "Sun, 06 Nov 1994 08:49:37 GMT"；
+// out 至少 HTTP_DATE_LEN + 1 字節，寫入後以 '\0' 結尾，返回 HTTP_DATE_LEN
+size_t http_format_date(time_t t, char* out);
+
+// 解析 IMF-fixdate，格式不對時返回 -1
+int http_parse_date(const char* s, time_t* out);
+
+// 標準狀態碼的原因短語，未知狀態碼返回空字符串
+const char* http_status_text(int status);
+
+// 在 arena 中創建空的響應，內存不足時返回 NULL
+HttpResponse* http_response_create(HttpArena* arena);
 
 #endif
\ No newline at end of file
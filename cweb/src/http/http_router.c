@@ -0,0 +1,469 @@
+#include "http/http_router_internal.h"
+
+#include "utils/log/logger.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ======== 構建樹 ========
+struct RouteNode {
+    char* prefix;               // 靜態節點為壓縮後的路徑片段，參數和通配符節點為參數名
+    size_t prefix_len;
+    RouteEntry entry;
+    int has_entry;
+
+    RouteNode** children;       // 靜態子節點
+    char* first;                // 各靜態子節點前綴的首字節，與 children 一一對應
+    size_t child_count;
+
+    RouteNode* param;
+    RouteNode* wildcard;
+};
+
+static RouteNode* node_new(const char* s, size_t len) {
+    RouteNode* n = calloc(1, sizeof(RouteNode));
+    if (!n) return NULL;
+    n->prefix = malloc(len + 1);
+    if (!n->prefix) {
+        free(n);
+        return NULL;
+    }
+    memcpy(n->prefix, s, len);
+    n->prefix[len] = '\0';
+    n->prefix_len = len;
+    return n;
+}
+
+static void node_free(RouteNode* n) {
+    if (!n) return;
+    for (size_t i = 0; i < n->child_count; i++) node_free(n->children[i]);
+    node_free(n->param);
+    node_free(n->wildcard);
+    free(n->children);
+    free(n->first);
+    free(n->prefix);
+    free(n);
+}
+
+static int node_empty(const RouteNode* n) {
+    return !n->has_entry && n->child_count == 0 && !n->param && !n->wildcard;
+}
+
+static int add_child(RouteNode* n, RouteNode* c) {
+    RouteNode** children = realloc(n->children, (n->child_count + 1) * sizeof(RouteNode*));
+    if (!children) return -1;
+    n->children = children;
+    char* first = realloc(n->first, n->child_count + 1);
+    if (!first) return -1;
+    n->first = first;
+
+    n->children[n->child_count] = c;
+    n->first[n->child_count] = c->prefix[0];
+    n->child_count++;
+    return 0;
+}
+
+static RouteNode* find_child(const RouteNode* n, char c, size_t* index) {
+    const char* f = n->child_count ? memchr(n->first, c, n->child_count) : NULL;
+    if (!f) return NULL;
+    if (index) *index = f - n->first;
+    return n->children[f - n->first];
+}
+
+// 在 n 之下插入靜態片段 s，必要時拆分已有節點，返回片段結束處的節點
+static RouteNode* insert_static(RouteNode* n, const char* s, size_t len) {
+    while (len > 0) {
+        size_t index;
+        RouteNode* c = find_child(n, s[0], &index);
+        if (!c) {
+            c = node_new(s, len);
+            if (!c) return NULL;
+            if (add_child(n, c) != 0) {
+                node_free(c);
+                return NULL;
+            }
+            return c;
+        }
+
+        size_t common = 0;
+        while (common < c->prefix_len && common < len && c->prefix[common] == s[common]) common++;
+
+        if (common < c->prefix_len) {
+            // c 的前 common 個字節成為新的中間節點，其餘部分掛在它下面
+            RouteNode* mid = node_new(c->prefix, common);
+            if (!mid) return NULL;
+            if (add_child(mid, c) != 0) {
+                node_free(mid);
+                return NULL;
+            }
+            memmove(c->prefix, c->prefix + common, c->prefix_len - common + 1);
+            c->prefix_len -= common;
+            mid->first[0] = c->prefix[0];
+            n->children[index] = mid;
+            c = mid;
+        }
+
+        n = c;
+        s += common;
+        len -= common;
+    }
+    return n;
+}
+
+// 刪除空的子樹，並把只剩一個靜態子節點的空靜態節點與它合併
+static void prune(RouteNode* n) {
+    size_t k = 0;
+    for (size_t i = 0; i < n->child_count; i++) {
+        RouteNode* c = n->children[i];
+        prune(c);
+        if (node_empty(c)) {
+            node_free(c);
+            continue;
+        }
+        if (!c->has_entry && !c->param && !c->wildcard && c->child_count == 1) {
+            RouteNode* gc = c->children[0];
+            char* prefix = malloc(c->prefix_len + gc->prefix_len + 1);
+            if (prefix) {
+                memcpy(prefix, c->prefix, c->prefix_len);
+                memcpy(prefix + c->prefix_len, gc->prefix, gc->prefix_len + 1);
+                free(gc->prefix);
+                gc->prefix = prefix;
+                gc->prefix_len += c->prefix_len;
+                c->child_count = 0;
+                node_free(c);
+                c = gc;
+            }
+        }
+        n->children[k] = c;
+        n->first[k] = c->prefix[0];
+        k++;
+    }
+    n->child_count = k;
+
+    if (n->param) {
+        prune(n->param);
+        if (node_empty(n->param)) {
+            node_free(n->param);
+            n->param = NULL;
+        }
+    }
+    if (n->wildcard && node_empty(n->wildcard)) {
+        node_free(n->wildcard);
+        n->wildcard = NULL;
+    }
+}
+
+// 只檢查模式串本身，不涉及已有的路由
+static int pattern_valid(const char* pattern) {
+    if (!pattern || pattern[0] != '/') return 0;
+    size_t params = 0, name_bytes = 0;
+    for (const char* p = pattern; *p; p++) {
+        if (*p != ':' && *p != '*') continue;
+        const char* name = p + 1;
+        size_t len = strcspn(name, "/:*");
+        if (p[-1] != '/' || len == 0 || (name[len] && name[len] != '/')) return 0;
+        if (*p == '*' && name[len]) return 0;
+        params++;
+        name_bytes += len + 1;
+        p = name + len - 1;
+    }
+    return params <= HTTP_MAX_ROUTE_PARAMS && name_bytes <= HTTP_ROUTE_PARAM_NAME_BYTES;
+}
+
+int http_router_insert(RouteNode** root, const char* pattern, const RouteEntry* entry) {
+    if (!pattern_valid(pattern)) return -1;
+    if (!*root && !(*root = node_new("", 0))) return -1;
+
+    RouteNode* n = *root;
+    const char* p = pattern;
+    while (*p) {
+        if (*p != ':' && *p != '*') {
+            size_t len = strcspn(p, ":*");
+            n = insert_static(n, p, len);
+            if (!n) goto fail;
+            p += len;
+            continue;
+        }
+
+        const char* name = p + 1;
+        size_t len = strcspn(name, "/");
+        RouteNode** slot = *p == ':' ? &n->param : &n->wildcard;
+        if (*slot) {
+            // 同一位置的參數在所有路由中必須同名
+            if ((*slot)->prefix_len != len || memcmp((*slot)->prefix, name, len) != 0) goto fail;
+        } else if (!(*slot = node_new(name, len))) {
+            goto fail;
+        }
+        n = *slot;
+        p = name + len;
+    }
+
+    if (n->has_entry) LOG_WARN("Route %s registered twice, replacing the previous handler", pattern);
+    n->entry = *entry;
+    n->has_entry = 1;
+    return 0;
+
+fail:
+    // 回收途中新建的空節點
+    prune(*root);
+    return -1;
+}
+
+// 按模式串的結構逐段查找，參數名必須一致
+static RouteNode* find_exact(RouteNode* n, const char* p) {
+    while (n && *p) {
+        if (*p == ':' || *p == '*') {
+            const char* name = p + 1;
+            size_t len = strcspn(name, "/");
+            RouteNode* c = *p == ':' ? n->param : n->wildcard;
+            if (!c || c->prefix_len != len || memcmp(c->prefix, name, len) != 0) return NULL;
+            n = c;
+            p = name + len;
+            continue;
+        }
+        RouteNode* c = find_child(n, *p, NULL);
+        if (!c || c->prefix_len > strcspn(p, ":*") || memcmp(c->prefix, p, c->prefix_len) != 0)
+            return NULL;
+        n = c;
+        p += c->prefix_len;
+    }
+    return n;
+}
+
+int http_router_remove(RouteNode** root, const char* pattern) {
+    if (!*root || !pattern) return -1;
+    RouteNode* n = find_exact(*root, pattern);
+    if (!n || !n->has_entry) return -1;
+    n->has_entry = 0;
+    prune(*root);
+    return 0;
+}
+
+// ======== 凍結的路由表 ========
+typedef struct FrozenNode {
+    uint32_t prefix;            // 在 strings 中的偏移，以 '\0' 結尾
+    uint32_t prefix_len;
+    uint32_t children;          // 靜態子節點在 nodes 中連續存放，這是第一個的下標
+    uint32_t child_count;
+    int32_t param;              // nodes 中的下標，-1 表示沒有
+    int32_t wildcard;
+    int32_t entry;              // entries 中的下標，-1 表示沒有
+} FrozenNode;
+
+struct RouteTable {
+    RouteEntry* entries;
+    FrozenNode* nodes;
+    char* first;                // first[i] 為 nodes[i] 前綴的首字節，匹配時在連續的子節點上 memchr
+    char* strings;
+    int32_t roots[HTTP_METHOD_COUNT];
+
+    uint64_t retired;           // 被替換時的紀元
+    RouteTable* next;           // 待回收鏈表
+};
+
+typedef struct TableBuilder {
+    RouteTable* t;
+    uint32_t nodes;
+    uint32_t entries;
+    uint32_t strings;
+} TableBuilder;
+
+static void count_nodes(const RouteNode* n, size_t* nodes, size_t* entries, size_t* strings) {
+    (*nodes)++;
+    if (n->has_entry) (*entries)++;
+    *strings += n->prefix_len + 1;
+    for (size_t i = 0; i < n->child_count; i++) count_nodes(n->children[i], nodes, entries, strings);
+    if (n->param) count_nodes(n->param, nodes, entries, strings);
+    if (n->wildcard) count_nodes(n->wildcard, nodes, entries, strings);
+}
+
+// 把 n 寫到 nodes[idx]；子節點的下標先整段分配好，再逐個遞歸
+static void emit_node(TableBuilder* b, const RouteNode* n, uint32_t idx) {
+    RouteTable* t = b->t;
+    FrozenNode* f = &t->nodes[idx];
+
+    f->prefix = b->strings;
+    f->prefix_len = (uint32_t)n->prefix_len;
+    memcpy(t->strings + b->strings, n->prefix, n->prefix_len + 1);
+    b->strings += (uint32_t)n->prefix_len + 1;
+    t->first[idx] = n->prefix[0];
+
+    f->entry = -1;
+    if (n->has_entry) {
+        f->entry = (int32_t)b->entries;
+        t->entries[b->entries++] = n->entry;
+    }
+
+    f->children = b->nodes;
+    f->child_count = (uint32_t)n->child_count;
+    b->nodes += (uint32_t)n->child_count;
+    f->param = n->param ? (int32_t)b->nodes++ : -1;
+    f->wildcard = n->wildcard ? (int32_t)b->nodes++ : -1;
+
+    for (size_t i = 0; i < n->child_count; i++) emit_node(b, n->children[i], f->children + (uint32_t)i);
+    if (n->param) emit_node(b, n->param, (uint32_t)f->param);
+    if (n->wildcard) emit_node(b, n->wildcard, (uint32_t)f->wildcard);
+}
+
+RouteTable* http_route_table_build(RouteNode* const roots[HTTP_METHOD_COUNT]) {
+    size_t nodes = 0, entries = 0, strings = 0;
+    for (int m = 0; m < HTTP_METHOD_COUNT; m++)
+        if (roots[m]) count_nodes(roots[m], &nodes, &entries, &strings);
+
+    // 一次分配，按對齊要求從大到小排列
+    RouteTable* t = malloc(sizeof(RouteTable) + entries * sizeof(RouteEntry) +
+                           nodes * sizeof(FrozenNode) + nodes + strings);
+    if (!t) return NULL;
+    memset(t, 0, sizeof(RouteTable));
+    t->entries = (RouteEntry*)(t + 1);
+    t->nodes = (FrozenNode*)(t->entries + entries);
+    t->first = (char*)(t->nodes + nodes);
+    t->strings = t->first + nodes;
+
+    TableBuilder b = { t, 0, 0, 0 };
+    for (int m = 0; m < HTTP_METHOD_COUNT; m++) {
+        t->roots[m] = -1;
+        if (!roots[m]) continue;
+        t->roots[m] = (int32_t)b.nodes++;
+        emit_node(&b, roots[m], (uint32_t)t->roots[m]);
+    }
+    return t;
+}
+
+static void push_param(const RouteTable* t, const FrozenNode* n, size_t off, size_t len,
+                       HttpRouteParam* params, size_t* count) {
+    HttpRouteParam* prm = &params[(*count)++];
+    prm->name = t->strings + n->prefix;
+    prm->value.off = (uint32_t)off;
+    prm->value.len = (uint32_t)len;
+}
+
+// n 的前綴已匹配到 pos 之前，返回 entry 的下標；失敗時 count 恢復原值
+static int match_node(const RouteTable* t, const FrozenNode* n, const char* path, size_t len, size_t pos,
+                      HttpRouteParam* params, size_t* count) {
+    const FrozenNode* w = n->wildcard >= 0 ? &t->nodes[n->wildcard] : NULL;
+    if (pos == len) {
+        if (n->entry >= 0) return n->entry;
+        if (w && w->entry >= 0) {
+            push_param(t, w, pos, 0, params, count);
+            return w->entry;
+        }
+        return -1;
+    }
+
+    const char* f = n->child_count ? memchr(t->first + n->children, path[pos], n->child_count) : NULL;
+    if (f) {
+        const FrozenNode* c = &t->nodes[f - t->first];
+        if (len - pos >= c->prefix_len && memcmp(path + pos, t->strings + c->prefix, c->prefix_len) == 0) {
+            int e = match_node(t, c, path, len, pos + c->prefix_len, params, count);
+            if (e >= 0) return e;
+        }
+    }
+
+    // 靜態分支失敗時才回退到參數，回退只發生在路徑段邊界
+    if (n->param >= 0) {
+        const char* slash = memchr(path + pos, '/', len - pos);
+        size_t end = slash ? (size_t)(slash - path) : len;
+        if (end > pos) {
+            const FrozenNode* c = &t->nodes[n->param];
+            size_t saved = *count;
+            push_param(t, c, pos, end - pos, params, count);
+            int e = match_node(t, c, path, len, end, params, count);
+            if (e >= 0) return e;
+            *count = saved;
+        }
+    }
+
+    if (w && w->entry >= 0) {
+        push_param(t, w, pos, len - pos, params, count);
+        return w->entry;
+    }
+    return -1;
+}
+
+// ======== 發佈與回收 ========
+// 基於紀元的回收：讀者進入時在自己的槽位記下當前紀元，離開時清零。
+// 舊表在替換時記下紀元 E，所有槽位都為 0 或大於 E 之後，就沒有讀者還能看到它
+typedef struct EpochSlot {
+    _Atomic uint64_t epoch;     // 0 表示不在臨界區
+    struct EpochSlot* next;
+} EpochSlot;
+
+static _Atomic(RouteTable*) g_table;
+static _Atomic uint64_t g_epoch = 1;
+static _Atomic(EpochSlot*) g_slots;         // 只增不減，綫程退出後它的槽位一直為 0
+static _Thread_local EpochSlot* t_slot;
+static RouteTable* g_retired;               // 只由寫者訪問
+
+static EpochSlot* epoch_slot(void) {
+    if (t_slot) return t_slot;
+    EpochSlot* s = calloc(1, sizeof(EpochSlot));
+    if (!s) return NULL;
+    s->next = atomic_load(&g_slots);
+    while (!atomic_compare_exchange_weak(&g_slots, &s->next, s)) {}
+    t_slot = s;
+    return s;
+}
+
+// 仍在臨界區中的讀者的最小紀元，沒有讀者時返回 UINT64_MAX
+static uint64_t oldest_reader(void) {
+    uint64_t oldest = UINT64_MAX;
+    for (EpochSlot* s = atomic_load(&g_slots); s; s = s->next) {
+        uint64_t e = atomic_load(&s->epoch);
+        if (e && e < oldest) oldest = e;
+    }
+    return oldest;
+}
+
+void http_router_publish(RouteTable* table) {
+    RouteTable* old = atomic_exchange(&g_table, table);
+    if (old) {
+        old->retired = atomic_fetch_add(&g_epoch, 1);
+        old->next = g_retired;
+        g_retired = old;
+    }
+
+    // 讀者的臨界區只有一次匹配，通常這裡就能回收；否則留到下次發佈
+    uint64_t oldest = oldest_reader();
+    RouteTable** pp = &g_retired;
+    while (*pp) {
+        RouteTable* t = *pp;
+        if (t->retired < oldest) {
+            *pp = t->next;
+            free(t);
+        } else {
+            pp = &t->next;
+        }
+    }
+}
+
+int http_router_lookup(HttpMethod method, const char* path, size_t len, RouteEntry* out,
+                       HttpRouteParam* params, size_t* param_count, char* names) {
+    *param_count = 0;
+    EpochSlot* s = epoch_slot();
+    if (!s) return -1;
+
+    // 先登記紀元再讀表指針，兩者都是順序一致的，寫者掃描槽位時一定能看到這次登記
+    atomic_store(&s->epoch, atomic_load(&g_epoch));
+    const RouteTable* t = atomic_load(&g_table);
+
+    int e = -1;
+    if (t && t->roots[method] >= 0)
+        e = match_node(t, &t->nodes[t->roots[method]], path, len, 0, params, param_count);
+    if (e >= 0) {
+        *out = t->entries[e];
+        // 離開臨界區後表可能被釋放，參數名要複製出來
+        for (size_t i = 0; i < *param_count; i++) {
+            size_t n = strlen(params[i].name) + 1;
+            memcpy(names, params[i].name, n);
+            params[i].name = names;
+            names += n;
+        }
+    }
+
+    atomic_store_explicit(&s->epoch, 0, memory_order_release);
+    if (e < 0) *param_count = 0;
+    return e >= 0 ? 0 : -1;
+}
@@ -0,0 +1,35 @@
+#ifndef HTTP_ROUTER_INTERNAL_H
+#define HTTP_ROUTER_INTERNAL_H
+
+#include "http/http_request_internal.h"
+#include "http/http_server_internal.h"
+
+#include <stddef.h>
+
+// 壓縮前綴樹：靜態片段按首字節分支，每個節點最多一個 ":name" 子節點和一個 "*name" 子節點。
+// 只在註冊時修改，由調用方串行化；請求從凍結後的 RouteTable 中匹配
+typedef struct RouteNode RouteNode;
+
+// 由前綴樹壓平而成的只讀路由表，節點、字符串和 entry 各存放在連續數組中
+typedef struct RouteTable RouteTable;
+
+// 插入模式串，如 "/users/:id"、"/static/*path"；參數必須佔據整個路徑段，通配符只能在末尾。
+// entry 按值複製；同一模式重複註冊時替換舊的 entry。模式非法或參數名衝突時返回 -1
+int http_router_insert(RouteNode** root, const char* pattern, const RouteEntry* entry);
+
+// 刪除與註冊時完全相同的模式串，並回收不再使用的節點；不存在時返回 -1
+int http_router_remove(RouteNode** root, const char* pattern);
+
+// 把各方法的前綴樹（可為 NULL）壓平成一張新表，內存不足時返回 NULL
+RouteTable* http_route_table_build(RouteNode* const roots[HTTP_METHOD_COUNT]);
+
+// 原子地發佈新表；舊表在所有可能讀到它的查找結束後才釋放。寫者之間由調用方串行化
+void http_router_publish(RouteTable* table);
+
+// 無鎖查找：匹配 path，優先級：靜態片段 > 參數 > 通配符。不分配內存（每個綫程首次調用除外）。
+// 命中時把 entry 複製到 out，參數名複製到 names（至少 HTTP_ROUTE_PARAM_NAME_BYTES 字節），
+// 參數值的偏移相對 path；未命中返回 -1
+int http_router_lookup(HttpMethod method, const char* path, size_t len, RouteEntry* out,
+                       HttpRouteParam* params, size_t* param_count, char* names);
+
+#endif
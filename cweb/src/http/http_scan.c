@@ -0,0 +1,122 @@
+#include "http/http_scan_internal.h"
+
+#include <stdint.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define HTTP_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+// 每個字節所屬的 HttpCharClass
+static const unsigned char g_chars[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    4, 7, 6, 7, 7, 7, 7, 7, 6, 6, 7, 7, 6, 7, 7, 6,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 6, 6, 6, 6, 6, 6,
+    6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 6, 6, 6, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 6, 7, 6, 7, 0,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+};
+
+static size_t scan_scalar(const unsigned char* s, size_t i, size_t len, HttpCharClass cls) {
+    while (i < len && (g_chars[s[i]] & cls)) i++;
+    return i;
+}
+
+#ifdef HTTP_SCAN_X86
+
+// ======== SSE4.2 ========
+// pcmpestri 一次最多比較 8 個字節區間。token 的補集超過 8 個區間，
+// 這裡用一個超集找出候選位置，再查表確認（同 picohttpparser）
+__attribute__((target("sse4.2")))
+static size_t scan_sse42(const unsigned char* s, size_t len, HttpCharClass cls) {
+    static const char token_stops[16] = "\x00\x20" "\"\"" "()" ",," "//" ":@" "[]" "{\xff";
+    static const char target_stops[16] = "\x00\x20" "\x7f\x7f";
+    static const char value_stops[16] = "\x00\x08" "\x0a\x1f" "\x7f\x7f";
+
+    const char* stops;
+    int n_stops;
+    switch (cls) {
+    case HTTP_CHARS_TOKEN:  stops = token_stops;  n_stops = 16; break;
+    case HTTP_CHARS_TARGET: stops = target_stops; n_stops = 4;  break;
+    default:                stops = value_stops;  n_stops = 6;  break;
+    }
+    __m128i ranges = _mm_loadu_si128((const __m128i*)stops);
+
+    size_t i = 0;
+    while (i + 16 <= len) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+        int idx = _mm_cmpestri(ranges, n_stops, v, 16,
+                               _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+        if (idx == 16) {
+            i += 16;
+            continue;
+        }
+        i += idx;
+        if (!(g_chars[s[i]] & cls)) return i;
+        i++;
+    }
+    return scan_scalar(s, i, len, cls);
+}
+
+// ======== AVX2 ========
+// 返回 v 中不屬於 cls 的字節位置的掩碼
+__attribute__((target("avx2")))
+static inline __m256i stop_mask_avx2(__m256i v, HttpCharClass cls) {
+    if (cls == HTTP_CHARS_TOKEN) {
+        // 按高低半字節查表：tchar 的高半字節只有 2..7，各佔一位，
+        // lo_bits[l] 記錄低半字節為 l 時哪些高半字節構成 tchar
+        const __m256i lo_bits = _mm256_setr_epi8(
+            0x3a, 0x3f, 0x3e, 0x3f, 0x3f, 0x3f, 0x3f, 0x3f, 0x3e, 0x3e, 0x3d, 0x15, 0x34, 0x15, 0x3d, 0x1c,
+            0x3a, 0x3f, 0x3e, 0x3f, 0x3f, 0x3f, 0x3f, 0x3f, 0x3e, 0x3e, 0x3d, 0x15, 0x34, 0x15, 0x3d, 0x1c);
+        const __m256i hi_bits = _mm256_setr_epi8(
+            0, 0, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i nibble = _mm256_set1_epi8(0x0f);
+        __m256i lo = _mm256_shuffle_epi8(lo_bits, _mm256_and_si256(v, nibble));
+        __m256i hi = _mm256_shuffle_epi8(hi_bits, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+        return _mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256());
+    }
+
+    // 無符號比較 v <= k 等價於 min(v, k) == v
+    __m256i del = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7f));
+    if (cls == HTTP_CHARS_TARGET) {
+        __m256i ctl_sp = _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x20)), v);
+        return _mm256_or_si256(ctl_sp, del);
+    }
+    __m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1f)), v);
+    __m256i tab = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'));
+    return _mm256_or_si256(_mm256_andnot_si256(tab, ctl), del);
+}
+
+__attribute__((target("avx2")))
+static size_t scan_avx2(const unsigned char* s, size_t len, HttpCharClass cls) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(s + i));
+        uint32_t stop = (uint32_t)_mm256_movemask_epi8(stop_mask_avx2(v, cls));
+        if (stop) return i + (size_t)__builtin_ctz(stop);
+    }
+    return scan_scalar(s, i, len, cls);
+}
+
+#endif
+
+size_t http_scan(const char* p, size_t len, HttpCharClass cls) {
+    const unsigned char* s = (const unsigned char*)p;
+#ifdef HTTP_SCAN_X86
+    // 不足一個向量時直接查表
+    if (len >= 32 && __builtin_cpu_supports("avx2")) return scan_avx2(s, len, cls);
+    if (len >= 16 && __builtin_cpu_supports("sse4.2")) return scan_sse42(s, len, cls);
+#endif
+    return scan_scalar(s, 0, len, cls);
+}
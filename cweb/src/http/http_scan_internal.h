@@ -0,0 +1,17 @@
+#ifndef HTTP_SCAN_INTERNAL_H
+#define HTTP_SCAN_INTERNAL_H
+
+#include <stddef.h>
+
+// 請求頭中各部分允許的字符，可按位組合
+typedef enum HttpCharClass {
+    HTTP_CHARS_TOKEN  = 1 << 0,     // tchar：方法、頭部名稱
+    HTTP_CHARS_TARGET = 1 << 1,     // VCHAR 和 obs-text：請求目標、版本
+    HTTP_CHARS_VALUE  = 1 << 2      // VCHAR、SP、HTAB 和 obs-text：頭部值
+} HttpCharClass;
+
+// 返回 p 中第一個不屬於 cls 的字節的下標，全部屬於時返回 len。
+// 按 CPU 支持選擇 AVX2（每次 32 字節）、SSE4.2（16 字節）或查表實現
+size_t http_scan(const char* p, size_t len, HttpCharClass cls);
+
+#endif
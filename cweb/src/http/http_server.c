@@ -1,120 +1,181 @@
 #include "http/http.h"
-#include "http/http_paser_internal.h"
+#include "http/http_internal.h"
+#include "http/http_reader_internal.h"
 #include "http/http_request_internal.h"
 #include "http/http_response_internal.h"
+#include "http/http_router_internal.h"
+#include "http/http_server_internal.h"
+#include "http/http_writer_internal.h"
 
 #include "utils/log/logger.h"
 
+#include <stdatomic.h>
 #include <string.h>
 #include <stdlib.h>
 
-#define ROUTE_HASH_SIZE 128
+// 每個方法一棵可修改的路由樹，每次修改後凍結成新表發佈給讀者。
+// 註冊可能在服務器運行時從任意綫程發生，寫者之間用自旋鎖串行化，查找不受影響
+static RouteNode* route_roots[HTTP_METHOD_COUNT];
+static atomic_flag route_lock = ATOMIC_FLAG_INIT;
 
-typedef struct RouteEntry {
-    char* route;
-    RouteHandler handler;
-    struct RouteEntry* next;
-} RouteEntry;
-
-typedef struct RouteBucket {
-    RouteEntry* head;
-} RouteBucket;
+static void route_lock_acquire(void) {
+    while (atomic_flag_test_and_set_explicit(&route_lock, memory_order_acquire)) thread_sleep(1);
+}
 
-static RouteBucket route_table[4][ROUTE_HASH_SIZE];
+static void route_lock_release(void) {
+    atomic_flag_clear_explicit(&route_lock, memory_order_release);
+}
 
-static uint32_t hash_route(const char* str) {
-    uint32_t hash = 5381;
-    while (*str) {
-        hash = ((hash << 5) + hash) + (unsigned char)(*str);
-        str++;
+// 調用方持有 route_lock
+static void publish_routes(void) {
+    RouteTable* table = http_route_table_build(route_roots);
+    if (!table) {
+        LOG_ERROR("Failed to build route table, keeping the previous one");
+        return;
     }
-    return hash % ROUTE_HASH_SIZE;
+    http_router_publish(table);
 }
 
-static void register_route(HttpMethod method, const char* route, RouteHandler handler) {
+static void register_route(HttpMethod method, const char* route, RouteHandler handler, BodyChunkHandler on_chunk) {
     if (!route || !handler) return;
-    uint32_t h = hash_route(route);
 
-    RouteEntry* entry = malloc(sizeof(RouteEntry));
-    entry->route = strdup(route);
-    entry->handler = handler;
-    entry->next = route_table[method][h].head;
-    route_table[method][h].head = entry;
+    RouteEntry entry = { handler, on_chunk };
+    route_lock_acquire();
+    if (http_router_insert(&route_roots[method], route, &entry) == 0)
+        publish_routes();
+    else
+        LOG_ERROR("Failed to register route: %s", route);
+    route_lock_release();
 }
 
-void register_get_route(const char* route, RouteHandler handler)    { register_route(GET, route, handler); }
-void register_post_route(const char* route, RouteHandler handler)   { register_route(POST, route, handler); }
-void register_put_route(const char* route, RouteHandler handler)    { register_route(PUT, route, handler); }
-void register_delete_route(const char* route, RouteHandler handler) { register_route(DEL, route, handler); }
+void register_get_route(const char* route, RouteHandler handler)    { register_route(GET, route, handler, NULL); }
+void register_post_route(const char* route, RouteHandler handler)   { register_route(POST, route, handler, NULL); }
+void register_put_route(const char* route, RouteHandler handler)    { register_route(PUT, route, handler, NULL); }
+void register_delete_route(const char* route, RouteHandler handler) { register_route(DEL, route, handler, NULL); }
 
-void handle_client(NetSocket* s, NetSocket* client) {
-    char buf[4096];
-    LOG_TRACE("Waiting to receive data from client...");
-    int n = net_recv(client, buf, sizeof(buf)-1);
-    if (n <= 0) {
-        LOG_WARN("Client disconnected or recv error: n=%d", n);
-        return;
-    }
-    buf[n] = '\0';
-    LOG_DEBUG("Received %d bytes from client", n);
+void register_post_stream_route(const char* route, BodyChunkHandler on_chunk, RouteHandler handler) {
+    register_route(POST, route, handler, on_chunk);
+}
+void register_put_stream_route(const char* route, BodyChunkHandler on_chunk, RouteHandler handler) {
+    register_route(PUT, route, handler, on_chunk);
+}
 
-    HttpRequest* req = parse_http_request(buf, n); // 假設 parse 也可以拿 client 填充 IP
-    if (!req) {
-        LOG_WARN("Failed to parse HTTP request");
-        return;
+int unregister_route(HttpMethod method, const char* route) {
+    if (!route) return -1;
+    route_lock_acquire();
+    int r = http_router_remove(&route_roots[method], route);
+    if (r == 0) publish_routes();
+    route_lock_release();
+    return r;
+}
+
+const RouteEntry* http_find_route(HttpRequest* req, RouteEntry* out) {
+    const char* path = http_view_str(req, req->route);
+    char* names = req->param_buf + req->route.len + 1;
+    if (http_router_lookup(req->method, path, req->route.len, out, req->params, &req->param_count, names) != 0)
+        return NULL;
+
+    if (req->param_count > 0) {
+        // 參數值在路徑的副本中就地結尾，路徑本身保持完整
+        memcpy(req->param_buf, path, req->route.len);
+        for (size_t i = 0; i < req->param_count; i++) {
+            HttpStrView v = req->params[i].value;
+            req->param_buf[v.off + v.len] = '\0';
+        }
     }
+    return out;
+}
 
+HttpResponse* http_dispatch_request(NetSocket* client, HttpRequest* req, const RouteEntry* route, int allow_keep_alive) {
     const char* ip = net_get_ip(client);
     const uint16_t port = net_get_port(client);
     LOG_INFO("Request from: %s:%d -> %s %s", ip, port, 
-                                                req->method == GET ? "GET" :
-                                                req->method == POST ? "POST" : 
-                                                req->method == PUT ? "PUT" : "DELETE",
-                                                req->route);
+             req->method == GET ? "GET" :
+             req->method == POST ? "POST" : 
+             req->method == PUT ? "PUT" : "DELETE",
+             http_request_get_route(req));
 
-    HttpResponse* res = malloc(sizeof(HttpResponse));
+    HttpResponse* res = http_response_create(req->arena);
     if (!res) {
         LOG_ERROR("Failed to allocate HttpResponse");
-        free_request(req);
-        return;
+        return NULL;
     }
-    memset(res, 0, sizeof(HttpResponse));
-
-    // 查找 handler
-    LOG_TRACE("Looking up handler for route: %s", req->route);
-    uint32_t h = hash_route(req->route);
-    RouteEntry* e = route_table[req->method][h].head;
-    while (e) {
-        if (strcmp(e->route, req->route) == 0) {
-            LOG_DEBUG("Handler found for route: %s", req->route);
-            e->handler(req, res);
-            break;
-        }
-        e = e->next;
+    res->keep_alive = allow_keep_alive && http_request_keep_alive(req);
+    res->chunked_ok = http_request_is_http11(req);
+    res->accept_encoding = http_request_get_known_header(req, HTTP_HEADER_ACCEPT_ENCODING);
+    if (req->method == GET) {
+        res->if_none_match = http_request_get_known_header(req, HTTP_HEADER_IF_NONE_MATCH);
+        res->if_modified_since = http_request_get_known_header(req, HTTP_HEADER_IF_MODIFIED_SINCE);
+        res->range = http_request_get_known_header(req, HTTP_HEADER_RANGE);
+        res->if_range = http_request_get_known_header(req, HTTP_HEADER_IF_RANGE);
     }
 
-    if (!e) {
-        LOG_WARN("No handler matched for route: %s", req->route);
+    if (route) {
+        LOG_DEBUG("Handler found for route: %s", http_request_get_route(req));
+        route->handler(req, res);
+    } else {
+        LOG_WARN("No handler matched for route: %s", http_request_get_route(req));
         http_response_status_not_found(res);
         http_response_set_text(res, "Route not found");
     }
+    return res;
+}
+
+void handle_client(NetSocket* s, NetSocket* client) {
+    char buf[HTTP_MAX_HEADER_BYTES + 1];
+    size_t len = 0;
+    HttpReader reader;
+    http_reader_init(&reader);
+
+    // 阻塞讀取，直到收齊一個請求（包括完整的 body）
+    LOG_TRACE("Waiting to receive data from client...");
+    int r = HTTP_READ_MORE;
+    while (r == HTTP_READ_MORE) {
+        int n = net_recv(client, buf + len, (int)(sizeof(buf) - len));
+        if (n <= 0) {
+            LOG_WARN("Client disconnected or recv error: n=%d", n);
+            http_reader_free(&reader);
+            return;
+        }
+        len += n;
+        LOG_DEBUG("Received %d bytes from client", n);
+
+        size_t used = 0;
+        r = http_reader_feed(&reader, buf, len, &used);
+        len -= used;
+        memmove(buf, buf + used, len);
+
+        if (reader.expect_continue) {
+            net_send(client, HTTP_CONTINUE_LINE, (int)strlen(HTTP_CONTINUE_LINE));
+            reader.expect_continue = 0;
+        }
+    }
+
+    HttpResponse* res = http_reader_respond(&reader, client, 0);
+    if (!res) {
+        http_reader_free(&reader);
+        return;
+    }
 
     // 生成并发送响应
     LOG_TRACE("Building HTTP response...");
-    size_t len;
-    char* resp_buf = build_http_response(res, &len);
-    if (resp_buf) {
-        LOG_DEBUG("Sending response, %zu bytes", len);
-        net_send(client, resp_buf, len);
-        free(resp_buf);
+    HttpWriter writer;
+    http_writer_init(&writer);
+    if (http_writer_add_response(&writer, res) == 0) {
+        LOG_DEBUG("Sending response, %llu bytes", (unsigned long long)writer.pending);
+        // producer 暫時沒有數據時稍等再試，不空轉佔滿 CPU
+        while (http_writer_flush(&writer, client) == 2) {
+            if (!http_writer_produce(&writer)) thread_sleep(HTTP_STREAM_RETRY_MS);
+        }
         LOG_TRACE("Response sent successfully");
     } else {
         LOG_ERROR("Failed to build HTTP response");
+        free_response(res);
     }
+    http_writer_free(&writer);
+    http_reader_free(&reader);     // 響應在讀取器的 arena 中，寫完後才能釋放
 
-    free_request(req);
-    free_response(res);
-    LOG_TRACE("Finished handling client %s:%d", ip, port);
+    LOG_TRACE("Finished handling client");
 }
 
 void* handle_client_task(void* arg) {
@@ -124,66 +185,7 @@ void* handle_client_task(void* arg) {
 
     free(t_arg); // 包装参数的内存可以释放
 
-    char buf[4096];
-    LOG_TRACE("Waiting to receive data from client...");
-    int n = net_recv(client, buf, sizeof(buf)-1);
-    if (n <= 0) {
-        LOG_WARN("Client disconnected or recv error: n=%d", n);
-        return NULL;
-    }
-    buf[n] = '\0';
-    LOG_DEBUG("Received %d bytes from client", n);
-
-    HttpRequest* req = parse_http_request(buf, n);
-    if (!req) {
-        LOG_WARN("Failed to parse HTTP request");
-        return NULL;
-    }
-
-    const char* ip = net_get_ip(client);
-    const uint16_t port = net_get_port(client);
-    LOG_INFO("Request from: %s:%d -> %s %s", ip, port, 
-             req->method == GET ? "GET" :
-             req->method == POST ? "POST" : 
-             req->method == PUT ? "PUT" : "DELETE",
-             req->route);
-
-    HttpResponse* res = malloc(sizeof(HttpResponse));
-    if (!res) {
-        LOG_ERROR("Failed to allocate HttpResponse");
-        free_request(req);
-        return NULL;
-    }
-    memset(res, 0, sizeof(HttpResponse));
-
-    // 查找 handler
-    uint32_t h = hash_route(req->route);
-    RouteEntry* e = route_table[req->method][h].head;
-    while (e) {
-        if (strcmp(e->route, req->route) == 0) {
-            e->handler(req, res);
-            break;
-        }
-        e = e->next;
-    }
-
-    if (!e) {
-        http_response_status_not_found(res);
-        http_response_set_text(res, "Route not found");
-    }
-
-    size_t len;
-    char* resp_buf = build_http_response(res, &len);
-    if (resp_buf) {
-        net_send(client, resp_buf, len);
-        free(resp_buf);
-    }
-
-    free_request(req);
-    free_response(res);
-
+    handle_client(s, client);
     net_close(client);
-
-    LOG_TRACE("Finished handling client %s:%d", ip, port);
     return NULL;
-}
\ No newline at end of file
+}
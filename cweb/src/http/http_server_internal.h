@@ -0,0 +1,20 @@
+#ifndef HTTP_SERVER_INTERNAL_H
+#define HTTP_SERVER_INTERNAL_H
+
+#include "http/http.h"
+#include "http/http_request_internal.h"
+#include <stddef.h>
+
+typedef struct RouteEntry {
+    RouteHandler handler;
+    BodyChunkHandler on_chunk;  // 非 NULL 時 body 以流式交給路由
+} RouteEntry;
+
+// 按方法和已解碼的路徑匹配路由：entry 複製到 out，捕獲的參數寫入 req。未命中返回 NULL
+const RouteEntry* http_find_route(HttpRequest* req, RouteEntry* out);
+
+// 執行路由，返回待發送的響應（與 req 同在 arena 中，由調用方 free_response）
+// route 為 NULL 時返回 404，內存不足時返回 NULL
+HttpResponse* http_dispatch_request(NetSocket* client, HttpRequest* req, const RouteEntry* route, int allow_keep_alive);
+
+#endif
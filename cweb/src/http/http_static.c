@@ -0,0 +1,179 @@
+#include "http/http.h"
+#include "http/http_request.h"
+#include "http/http_response.h"
+#include "http/http_static_internal.h"
+
+#include "utils/log/logger.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ======== MIME 類型 ========
+static const struct {
+    const char* ext;
+    const char* type;
+} g_mime_types[] = {
+    { "html",  "text/html; charset=utf-8" },
+    { "htm",   "text/html; charset=utf-8" },
+    { "css",   "text/css; charset=utf-8" },
+    { "js",    "text/javascript; charset=utf-8" },
+    { "mjs",   "text/javascript; charset=utf-8" },
+    { "json",  "application/json" },
+    { "map",   "application/json" },
+    { "txt",   "text/plain; charset=utf-8" },
+    { "md",    "text/markdown; charset=utf-8" },
+    { "csv",   "text/csv; charset=utf-8" },
+    { "xml",   "application/xml" },
+    { "svg",   "image/svg+xml" },
+    { "png",   "image/png" },
+    { "jpg",   "image/jpeg" },
+    { "jpeg",  "image/jpeg" },
+    { "gif",   "image/gif" },
+    { "webp",  "image/webp" },
+    { "avif",  "image/avif" },
+    { "ico",   "image/x-icon" },
+    { "woff",  "font/woff" },
+    { "woff2", "font/woff2" },
+    { "ttf",   "font/ttf" },
+    { "otf",   "font/otf" },
+    { "wasm",  "application/wasm" },
+    { "pdf",   "application/pdf" },
+    { "zip",   "application/zip" },
+    { "gz",    "application/gzip" },
+    { "mp4",   "video/mp4" },
+    { "webm",  "video/webm" },
+    { "mp3",   "audio/mpeg" },
+    { "ogg",   "audio/ogg" },
+    { "wav",   "audio/wav" },
+};
+
+static int ext_equals(const char* ext, const char* lower) {
+    size_t i = 0;
+    while (ext[i] && lower[i] && (ext[i] | 0x20) == lower[i]) i++;
+    return !ext[i] && !lower[i];
+}
+
+const char* http_mime_type(const char* path) {
+    const char* dot = path ? strrchr(path, '.') : NULL;
+    if (dot && !strchr(dot, '/')) {
+        for (size_t i = 0; i < sizeof(g_mime_types) / sizeof(g_mime_types[0]); i++) {
+            if (ext_equals(dot + 1, g_mime_types[i].ext)) return g_mime_types[i].type;
+        }
+    }
+    return "application/octet-stream";
+}
+
+// ======== 靜態目錄 ========
+// 註冊後不再修改也不釋放，只在表頭插入，處理請求時無鎖遍歷
+typedef struct StaticMount {
+    char* prefix;
+    size_t prefix_len;
+    char* dir;
+    size_t dir_len;
+    struct StaticMount* next;
+} StaticMount;
+
+static _Atomic(StaticMount*) g_mounts;
+
+// 請求路徑落在哪個目錄下，前綴最長者優先；同一前綴以最後註冊的為準
+static const StaticMount* find_mount(const char* route) {
+    const StaticMount* best = NULL;
+    for (const StaticMount* m = atomic_load_explicit(&g_mounts, memory_order_acquire); m; m = m->next) {
+        if (strncmp(route, m->prefix, m->prefix_len) != 0) continue;
+        if (route[m->prefix_len] != '/' && route[m->prefix_len] != '\0') continue;
+        if (!best || m->prefix_len > best->prefix_len) best = m;
+    }
+    return best;
+}
+
+// 把通配符捕獲的相對路徑規範化到 out（至少 strlen(rel) + 12 字節）：去掉空段和 "."，
+// 以 '/' 結尾或為空時指向 index.html。含 ".."、'\' 或 ':' 時返回 -1，路徑不會離開目錄；
+// 以 '.' 開頭的段（.git、.env 等隱藏文件和目錄）同樣返回 -1
+static int normalize_path(const char* rel, char* out) {
+    size_t n = 0;
+    const char* p = rel;
+    while (*p) {
+        const char* end = strchr(p, '/');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (memchr(p, '\\', len) || memchr(p, ':', len)) return -1;
+        if (len > 1 && p[0] == '.') return -1;
+        if (len > 0 && !(len == 1 && p[0] == '.')) {
+            if (n) out[n++] = '/';
+            memcpy(out + n, p, len);
+            n += len;
+        }
+        p += len;
+        if (*p) p++;
+    }
+
+    size_t rel_len = strlen(rel);
+    if (n == 0 || rel[rel_len - 1] == '/') {
+        if (n) out[n++] = '/';
+        memcpy(out + n, "index.html", 10);
+        n += 10;
+    }
+    out[n] = '\0';
+    return 0;
+}
+
+static void serve_static(const HttpRequest* req, HttpResponse* res) {
+    const char* rel = http_request_get_param(req, "path");
+    const StaticMount* m = find_mount(http_request_get_route(req));
+    if (!rel) rel = "";
+
+    size_t rel_len = strlen(rel);
+    char* path = m ? http_request_arena_alloc(req, m->dir_len + rel_len + 13) : NULL;
+    if (!path) {
+        http_response_status_not_found(res);
+        http_response_set_text(res, "File not found");
+        return;
+    }
+
+    memcpy(path, m->dir, m->dir_len);
+    path[m->dir_len] = '/';
+    if (normalize_path(rel, path + m->dir_len + 1) != 0) {
+        http_response_status_not_found(res);
+        http_response_set_text(res, "File not found");
+        return;
+    }
+
+    // 文件的打開、校驗和緩存由文件響應統一處理
+    http_response_status_ok(res);
+    http_response_set_file(res, path);
+}
+
+void register_static_dir(const char* prefix, const char* dir) {
+    if (!prefix || !dir || prefix[0] != '/' || strchr(prefix, ':') || strchr(prefix, '*') || !dir[0]) {
+        LOG_ERROR("Invalid static directory mount: %s", prefix ? prefix : "(null)");
+        return;
+    }
+
+    size_t prefix_len = strlen(prefix);
+    size_t dir_len = strlen(dir);
+    while (prefix_len > 0 && prefix[prefix_len - 1] == '/') prefix_len--;
+    while (dir_len > 1 && dir[dir_len - 1] == '/') dir_len--;
+
+    StaticMount* m = malloc(sizeof(StaticMount) + prefix_len + 1 + dir_len + 1);
+    if (!m) return;
+    m->prefix = (char*)(m + 1);
+    memcpy(m->prefix, prefix, prefix_len);
+    m->prefix[prefix_len] = '\0';
+    m->prefix_len = prefix_len;
+    m->dir = m->prefix + prefix_len + 1;
+    memcpy(m->dir, dir, dir_len);
+    m->dir[dir_len] = '\0';
+    m->dir_len = dir_len;
+
+    m->next = atomic_load_explicit(&g_mounts, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&g_mounts, &m->next, m,
+                                                  memory_order_release, memory_order_relaxed)) {
+    }
+
+    char* route = malloc(prefix_len + sizeof("/*path"));
+    if (!route) return;
+    memcpy(route, m->prefix, prefix_len);
+    memcpy(route + prefix_len, "/*path", sizeof("/*path"));
+    register_get_route(route, serve_static);
+    free(route);
+}
@@ -0,0 +1,7 @@
+#ifndef HTTP_STATIC_INTERNAL_H
+#define HTTP_STATIC_INTERNAL_H
+
+// 按擴展名（不區分大小寫）返回 Content-Type，文本類型帶 charset；未知時返回 application/octet-stream
+const char* http_mime_type(const char* path);
+
+#endif
@@ -0,0 +1,142 @@
+#include "http/http_timer_internal.h"
+
+#include <string.h>
+
+#define TIMER_SLOT_MASK  (TIMER_SLOTS - 1)
+#define TIMER_MAX_TICKS  ((uint64_t)1 << (TIMER_SLOT_BITS * TIMER_LEVELS))
+
+static void list_init(TimerNode* head) {
+    head->prev = head->next = head;
+}
+
+static int list_empty(const TimerNode* head) {
+    return head->next == head;
+}
+
+static void list_append(TimerNode* head, TimerNode* t) {
+    t->prev = head->prev;
+    t->next = head;
+    head->prev->next = t;
+    head->prev = t;
+}
+
+static void list_remove(TimerNode* t) {
+    t->prev->next = t->next;
+    t->next->prev = t->prev;
+    t->prev = t->next = NULL;
+}
+
+// 把 head 中的節點整體移到 out，原槽置空
+static void list_take(TimerNode* head, TimerNode* out) {
+    list_init(out);
+    if (list_empty(head)) return;
+    out->next = head->next;
+    out->prev = head->prev;
+    out->next->prev = out;
+    out->prev->next = out;
+    list_init(head);
+}
+
+void timer_wheel_init(TimerWheel* w, uint64_t now_ms, uint64_t tick_ms) {
+    memset(w, 0, sizeof(TimerWheel));
+    for (int l = 0; l < TIMER_LEVELS; l++)
+        for (int i = 0; i < TIMER_SLOTS; i++)
+            list_init(&w->slots[l][i]);
+    w->tick_ms = tick_ms ? tick_ms : 1;
+    w->current = now_ms / w->tick_ms;
+}
+
+// 按距離到期的 tick 數選擇層，槽位由絕對到期 tick 決定
+static void wheel_insert(TimerWheel* w, TimerNode* t) {
+    if (t->expire < w->current) t->expire = w->current;
+    uint64_t delta = t->expire - w->current;
+    if (delta >= TIMER_MAX_TICKS) {
+        t->expire = w->current + TIMER_MAX_TICKS - 1;
+        delta = TIMER_MAX_TICKS - 1;
+    }
+
+    int level = 0;
+    while (level < TIMER_LEVELS - 1 && delta >= ((uint64_t)1 << (TIMER_SLOT_BITS * (level + 1))))
+        level++;
+
+    size_t slot = (size_t)(t->expire >> (TIMER_SLOT_BITS * level)) & TIMER_SLOT_MASK;
+    list_append(&w->slots[level][slot], t);
+}
+
+void timer_wheel_schedule(TimerWheel* w, TimerNode* t, uint64_t expire_ms) {
+    if (t->active) list_remove(t);
+    else w->count++;
+
+    // 當前 tick 的槽已處理過，最早只能在下一個 tick 觸發（向上取整，不會提前）
+    uint64_t expire = (expire_ms + w->tick_ms - 1) / w->tick_ms;
+    t->expire = expire > w->current ? expire : w->current + 1;
+    t->active = 1;
+    wheel_insert(w, t);
+}
+
+void timer_wheel_cancel(TimerWheel* w, TimerNode* t) {
+    if (!t->active) return;
+    list_remove(t);
+    t->active = 0;
+    w->count--;
+}
+
+// 把高層對應槽中的定時器重新分配到低層
+static int cascade(TimerWheel* w, int level) {
+    size_t slot = (size_t)(w->current >> (TIMER_SLOT_BITS * level)) & TIMER_SLOT_MASK;
+    TimerNode pending;
+    list_take(&w->slots[level][slot], &pending);
+    while (!list_empty(&pending)) {
+        TimerNode* t = pending.next;
+        list_remove(t);
+        wheel_insert(w, t);
+    }
+    return (int)slot;
+}
+
+void timer_wheel_advance(TimerWheel* w, uint64_t now_ms, TimerExpire on_expire, void* ctx) {
+    uint64_t target = now_ms / w->tick_ms;
+
+    while (w->current < target) {
+        if (w->count == 0) {
+            w->current = target;
+            break;
+        }
+
+        w->current++;
+        size_t slot = (size_t)w->current & TIMER_SLOT_MASK;
+        if (slot == 0) {
+            for (int l = 1; l < TIMER_LEVELS && cascade(w, l) == 0; l++)
+                ;
+        }
+
+        // 先摘下整個槽，回調裡取消的節點會從這個臨時鏈表中移除
+        TimerNode expired;
+        list_take(&w->slots[0][slot], &expired);
+        while (!list_empty(&expired)) {
+            TimerNode* t = expired.next;
+            list_remove(t);
+            t->active = 0;
+            w->count--;
+            on_expire(t, ctx);
+        }
+    }
+}
+
+int timer_wheel_next_timeout(const TimerWheel* w, uint64_t now_ms, int max_ms) {
+    if (w->count == 0) return max_ms;
+
+    // 最近的非空低層槽；低層全空時在下一次進位（需要從高層搬移）時醒來
+    uint64_t next = (w->current | TIMER_SLOT_MASK) + 1;
+    for (uint64_t tick = w->current + 1; tick < next; tick++) {
+        if (!list_empty(&w->slots[0][tick & TIMER_SLOT_MASK])) {
+            next = tick;
+            break;
+        }
+    }
+
+    uint64_t at = next * w->tick_ms;
+    if (at <= now_ms) return 0;
+    uint64_t wait = at - now_ms;
+    return wait < (uint64_t)max_ms ? (int)wait : max_ms;
+}
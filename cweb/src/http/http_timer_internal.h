@@ -0,0 +1,41 @@
+#ifndef HTTP_TIMER_INTERNAL_H
+#define HTTP_TIMER_INTERNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 分層時間輪：4 層、每層 64 個槽，添加、取消和觸發都是 O(1)
+#define TIMER_LEVELS    4
+#define TIMER_SLOT_BITS 6
+#define TIMER_SLOTS     (1 << TIMER_SLOT_BITS)
+
+// 嵌入到被定時的對象中，未安排時 active 為 0
+typedef struct TimerNode {
+    struct TimerNode* prev;
+    struct TimerNode* next;
+    uint64_t expire;        // 到期的 tick
+    int active;
+} TimerNode;
+
+typedef struct TimerWheel {
+    TimerNode slots[TIMER_LEVELS][TIMER_SLOTS];  // 每個槽是以哨兵節點開頭的環形鏈表
+    uint64_t current;       // 已處理到的 tick
+    uint64_t tick_ms;
+    size_t count;
+} TimerWheel;
+
+typedef void (*TimerExpire)(TimerNode* t, void* ctx);
+
+void timer_wheel_init(TimerWheel* w, uint64_t now_ms, uint64_t tick_ms);
+
+// 安排或重新安排定時器在 expire_ms（與 time_now_ms 同一時鐘）到期
+void timer_wheel_schedule(TimerWheel* w, TimerNode* t, uint64_t expire_ms);
+void timer_wheel_cancel(TimerWheel* w, TimerNode* t);
+
+// 推進到 now_ms 並觸發到期的定時器；回調中可以取消或安排任意定時器
+void timer_wheel_advance(TimerWheel* w, uint64_t now_ms, TimerExpire on_expire, void* ctx);
+
+// 距下一次需要推進的毫秒數，不超過 max_ms
+int timer_wheel_next_timeout(const TimerWheel* w, uint64_t now_ms, int max_ms);
+
+#endif
@@ -0,0 +1,221 @@
+#include "http/http_writer_internal.h"
+#include "http/http_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SENDFILE_CHUNK (1u << 30)
+
+void http_writer_init(HttpWriter* w) {
+    memset(w, 0, sizeof(HttpWriter));
+}
+
+void http_writer_free(HttpWriter* w) {
+    if (!w) return;
+    for (int i = 0; i < w->count; i++) {
+        HttpWriteSeg* seg = &w->segs[w->first + i];
+        if (seg->owner) free_response(seg->owner);
+    }
+    free(w->segs);
+    free(w->heads);
+    memset(w, 0, sizeof(HttpWriter));
+}
+
+static HttpWriteSeg* push_seg(HttpWriter* w) {
+    if (w->first + w->count == w->cap) {
+        if (w->first > 0) {
+            memmove(w->segs, w->segs + w->first, sizeof(HttpWriteSeg) * w->count);
+            w->first = 0;
+        } else {
+            int cap = w->cap ? w->cap * 2 : 16;
+            HttpWriteSeg* ns = realloc(w->segs, sizeof(HttpWriteSeg) * cap);
+            if (!ns) return NULL;
+            w->segs = ns;
+            w->cap = cap;
+        }
+    }
+
+    HttpWriteSeg* seg = &w->segs[w->first + w->count];
+    memset(seg, 0, sizeof(HttpWriteSeg));
+    w->count++;
+    return seg;
+}
+
+int http_writer_add_response(HttpWriter* w, HttpResponse* res) {
+    if (!w || !res) return -1;
+
+    // 頭部直接序列化到 heads 緩衝區末尾
+    if (w->heads_cap - w->heads_len < HTTP_MAX_HEADER_BYTES) {
+        size_t cap = w->heads_cap ? w->heads_cap * 2 : HTTP_MAX_HEADER_BYTES * 2;
+        char* nb = realloc(w->heads, cap);
+        if (!nb) return -1;
+        w->heads = nb;
+        w->heads_cap = cap;
+    }
+
+    size_t head_len = build_http_response(res, w->heads + w->heads_len, HTTP_MAX_HEADER_BYTES);
+    if (head_len == 0) return -1;
+
+    int count = w->count;
+    HttpWriteSeg* seg = push_seg(w);
+    if (!seg) return -1;
+    seg->head_off = w->heads_len;
+    seg->len = head_len;
+
+    int has_file = res->file && res->file_size > 0;
+    int has_body = !res->file && res->body && res->body_length > 0;
+    if (res->stream) {
+        seg = push_seg(w);
+        if (!seg) {
+            w->count = count;
+            return -1;
+        }
+        // handler 中已寫出的數據
+        seg->stream = res;
+        w->pending += res->stream_len - res->stream_sent;
+    } else if (res->part_count > 0) {
+        for (size_t i = 0; i < res->part_count; i++) {
+            seg = push_seg(w);
+            if (!seg) {
+                w->count = count;
+                return -1;
+            }
+            const HttpBodyPart* part = &res->parts[i];
+            seg->data = part->data;
+            seg->file = part->data ? NULL : res->file;
+            seg->file_off = part->off;
+            seg->len = part->len;
+        }
+        w->pending += res->parts_length;
+    } else if (has_file || has_body) {
+        seg = push_seg(w);
+        if (!seg) {
+            // 只回退本次入隊的頭部段，push_seg 可能已搬移過隊列
+            w->count = count;
+            return -1;
+        }
+        seg->file = has_file ? res->file : NULL;
+        seg->data = has_body ? res->body : NULL;
+        seg->len = has_file ? res->file_size : res->body_length;
+        w->pending += seg->len;
+    }
+
+    seg->owner = res;
+    w->heads_len += head_len;
+    w->pending += head_len;
+    return 0;
+}
+
+int http_writer_add_data(HttpWriter* w, const char* data, size_t len) {
+    if (!w || !data || len == 0) return -1;
+
+    HttpWriteSeg* seg = push_seg(w);
+    if (!seg) return -1;
+    seg->data = data;
+    seg->len = len;
+    w->pending += len;
+    return 0;
+}
+
+static void pop_seg(HttpWriter* w) {
+    HttpWriteSeg* seg = &w->segs[w->first];
+    if (seg->owner) free_response(seg->owner);
+    w->first++;
+    w->count--;
+}
+
+static void advance(HttpWriter* w, uint64_t n) {
+    w->pending -= n;
+    while (n > 0 && w->count > 0) {
+        HttpWriteSeg* seg = &w->segs[w->first];
+        if (seg->stream) {
+            HttpResponse* res = seg->stream;
+            size_t left = res->stream_len - res->stream_sent;
+            size_t take = n < left ? (size_t)n : left;
+            res->stream_sent += take;
+            n -= take;
+            if (res->stream_sent < res->stream_len) break;
+            res->stream_len = res->stream_sent = 0;
+            if (!res->stream_ended) break;
+            pop_seg(w);
+            continue;
+        }
+
+        uint64_t left = seg->len - seg->done;
+        uint64_t take = n < left ? n : left;
+        seg->done += take;
+        n -= take;
+
+        if (seg->done == seg->len) pop_seg(w);
+    }
+
+    if (w->count == 0) {
+        w->first = 0;
+        w->heads_len = 0;
+    }
+}
+
+int http_writer_flush(HttpWriter* w, NetSocket* s) {
+    if (!w || !s) return -1;
+
+    while (w->count > 0) {
+        HttpWriteSeg* seg = &w->segs[w->first];
+
+        if (seg->stream && seg->stream->stream_len == seg->stream->stream_sent) {
+            if (!seg->stream->stream_ended) return 2;
+            pop_seg(w);
+            continue;
+        }
+
+        int64_t n;
+        if (seg->file) {
+            uint64_t left = seg->len - seg->done;
+            n = net_sendfile(s, seg->file, seg->file_off + seg->done,
+                             left > SENDFILE_CHUNK ? SENDFILE_CHUNK : (size_t)left);
+        } else {
+            // 聚合連續的內存段，一次 writev 寫出
+            NetIoVec iov[NET_IOV_MAX];
+            int n_iov = 0;
+            for (int i = 0; i < w->count && n_iov < NET_IOV_MAX; i++) {
+                HttpWriteSeg* m = &w->segs[w->first + i];
+                if (m->file) break;
+                if (m->stream) {
+                    // 流式段之後的數據要等流結束才能發送
+                    HttpResponse* res = m->stream;
+                    if (res->stream_len > res->stream_sent) {
+                        iov[n_iov].base = res->stream_buf + res->stream_sent;
+                        iov[n_iov].len = res->stream_len - res->stream_sent;
+                        n_iov++;
+                    }
+                    break;
+                }
+                const char* base = m->data ? m->data : w->heads + m->head_off;
+                iov[n_iov].base = base + m->done;
+                iov[n_iov].len = (size_t)(m->len - m->done);
+                n_iov++;
+            }
+            n = net_sendv(s, iov, n_iov);
+        }
+
+        if (n == NET_WOULD_BLOCK) return 0;
+        if (n <= 0) return -1;
+        advance(w, (uint64_t)n);
+    }
+    return 1;
+}
+
+int http_writer_starved(const HttpWriter* w) {
+    if (!w || w->count == 0) return 0;
+    const HttpResponse* res = w->segs[w->first].stream;
+    return res && !res->stream_ended && res->stream_len == res->stream_sent;
+}
+
+int http_writer_produce(HttpWriter* w) {
+    if (!http_writer_starved(w)) return 0;
+
+    HttpResponse* res = w->segs[w->first].stream;
+    size_t before = res->stream_len;
+    res->stream(res, res->stream_ctx);
+    w->pending += res->stream_len - before;
+    return res->stream_len != before || res->stream_ended;
+}
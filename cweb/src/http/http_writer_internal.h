@@ -0,0 +1,53 @@
+#ifndef HTTP_WRITER_INTERNAL_H
+#define HTTP_WRITER_INTERNAL_H
+
+#include "http/http_response_internal.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 待寫出的一段數據：頭部（位於 heads 緩衝區）、內存 body、文件區間或流式響應
+typedef struct HttpWriteSeg {
+    const char* data;       // 內存段；頭部段為 NULL，按 head_off 定位
+    size_t head_off;
+    FileHandle* file;       // 文件段
+    uint64_t file_off;
+    uint64_t len;
+    uint64_t done;          // 已寫出的字節數
+    HttpResponse* stream;   // 流式段：數據在 stream->stream_buf 中，長度事先未知
+    HttpResponse* owner;    // 掛在響應最後一段上，寫完後釋放
+} HttpWriteSeg;
+
+// 按順序寫出響應的隊列，頭部、body 和文件以 writev / sendfile 發送而不拼接
+typedef struct HttpWriter {
+    HttpWriteSeg* segs;
+    int first;
+    int count;
+    int cap;
+
+    char* heads;
+    size_t heads_len;
+    size_t heads_cap;
+
+    uint64_t pending;       // 尚未寫出的字節數
+} HttpWriter;
+
+void http_writer_init(HttpWriter* w);
+void http_writer_free(HttpWriter* w);
+
+// 序列化響應頭並入隊，成功後 res 歸 writer 所有
+int http_writer_add_response(HttpWriter* w, HttpResponse* res);
+
+// 入隊一段靜態數據（如 100 Continue），data 必須在寫出前一直有效
+int http_writer_add_data(HttpWriter* w, const char* data, size_t len);
+
+// 返回 1 全部寫完，0 socket 暫時不可寫，-1 出錯，2 隊首的流式響應在等待 producer 生成數據
+int http_writer_flush(HttpWriter* w, NetSocket* s);
+
+// 隊首流式響應的數據已全部發出、尚未結束時返回 1
+int http_writer_starved(const HttpWriter* w);
+
+// 調用隊首流式響應的 producer 生成下一部分數據；producer 既沒寫出數據也沒結束時返回 0
+int http_writer_produce(HttpWriter* w);
+
+#endif
@@ -0,0 +1,763 @@
+// io_uring 網絡後端（-DCWEB_IO_URING=ON）：替換 platform_posix.c 中的 accept / recv / close 和事件輪詢
+//
+// - 監聽 socket 使用 multishot accept，新連接在 net_poller_wait 中批量收割
+// - 連接使用 multishot recv + provided buffer ring，數據由內核直接寫入 poller 的緩衝區，
+//   net_recv 只從隊列中拷出，不再發起系統調用
+// - 註冊、修改和取消都只是填寫 SQE，在下一次 net_poller_wait 時和等待合併為一次 io_uring_enter
+//
+// 註冊到 poller 的 socket 只能在該 poller 的線程上 recv / accept / close，與事件循環的用法一致。
+// send / writev / sendfile 仍直接調用，它們是同步接口，且響應已經由 writev 聚合
+
+#define _GNU_SOURCE
+
+#include "utils/platform/platform.h"
+#include "utils/platform/platform_posix_internal.h"
+#include "utils/log/logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <linux/io_uring.h>
+
+#define URING_ENTRIES   1024
+#define URING_BUF_COUNT 512             // 每個 poller 提供給內核的接收緩衝區
+#define URING_BUF_SIZE  4096
+#define URING_BUF_GROUP 0
+
+#define URING_TAG_WAKE   ((uint64_t)1)  // eventfd 讀取
+#define URING_TAG_IGNORE ((uint64_t)0)  // 取消請求等不關心結果的操作
+
+typedef enum UringOpKind {
+    URING_OP_ACCEPT,
+    URING_OP_RECV,
+    URING_OP_POLL
+} UringOpKind;
+
+// 一個在途的 multishot 操作，收到最後一個 CQE（沒有 IORING_CQE_F_MORE）後釋放
+typedef struct UringOp {
+    UringOpKind kind;
+    NetSocket* s;               // socket 關閉後為 NULL，之後的結果直接丟棄
+    NetPoller* p;
+    unsigned seq;               // 對應 SQE 的序號，用於判斷是否已提交
+    int cancelled;
+} UringOp;
+
+typedef struct UringLink {
+    NetSocket* prev;
+    NetSocket* next;
+    int linked;
+} UringLink;
+
+struct UringSocket {
+    NetPoller* poller;          // 當前註冊的 poller，未註冊時為 NULL
+    NetPoller* buf_owner;       // 隊列中緩衝區所屬的 poller
+    void* udata;
+    int events;
+    int listening;
+
+    UringOp* accept_op;
+    UringOp* recv_op;
+    UringOp* poll_op;
+
+    // 已收到未讀取的緩衝區，按 bid 串成鏈表
+    int head;
+    int tail;
+    uint32_t head_off;
+
+    // 已接受未取走的連接
+    int* fds;
+    int fds_head;
+    int fds_count;
+    int fds_cap;
+
+    int eof;
+    int err;
+    int writable;
+
+    UringLink ready;            // 需要在 wait 中報告的 socket
+    UringLink starved;          // 緩衝區耗盡、等待重新發起 recv 的 socket
+};
+
+typedef struct UringBuf {
+    uint32_t len;
+    int next;
+} UringBuf;
+
+struct NetPoller {
+    int fd;
+
+    // SQ / CQ 映射
+    void* sq_ptr;
+    size_t sq_size;
+    void* cq_ptr;
+    size_t cq_size;
+    struct io_uring_sqe* sqes;
+    size_t sqes_size;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_array;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned sq_local_tail;     // 已填寫的 SQE，尚未對內核發佈
+    unsigned sq_submitted;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe* cqes;
+
+    // provided buffer ring
+    struct io_uring_buf_ring* br;
+    size_t br_size;
+    char* bufs;
+    UringBuf meta[URING_BUF_COUNT];
+    uint16_t br_tail;
+    int recycled;               // 上次 wait 之後歸還過緩衝區
+
+    int wakefd;
+    uint64_t wake_val;
+
+    NetSocket* ready_head;
+    NetSocket* starved_head;
+};
+
+// ======== 系統調用 ========
+static int uring_setup(unsigned entries, struct io_uring_params* params)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags, void* arg, size_t argsz)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+static int uring_register(int fd, unsigned opcode, void* arg, unsigned nr_args)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+// ======== 提交隊列 ========
+static int uring_submit(NetPoller* p, unsigned min_complete, unsigned flags, void* arg, size_t argsz)
+{
+    unsigned to_submit = p->sq_local_tail - p->sq_submitted;
+    __atomic_store_n(p->sq_tail, p->sq_local_tail, __ATOMIC_RELEASE);
+
+    int r;
+    do {
+        r = uring_enter(p->fd, to_submit, min_complete, flags, arg, argsz);
+    } while (r < 0 && errno == EINTR && to_submit > 0);
+
+    if (r >= 0) p->sq_submitted += (unsigned)r;
+    else if (errno != EINTR && errno != ETIME && errno != EBUSY && errno != EAGAIN) return -1;
+    return 0;
+}
+
+static struct io_uring_sqe* uring_get_sqe(NetPoller* p)
+{
+    unsigned head = __atomic_load_n(p->sq_head, __ATOMIC_ACQUIRE);
+    if (p->sq_local_tail - head >= p->sq_entries) {
+        // 隊列已滿，先提交已填寫的部分
+        if (uring_submit(p, 0, 0, NULL, 0) != 0) return NULL;
+        head = __atomic_load_n(p->sq_head, __ATOMIC_ACQUIRE);
+        if (p->sq_local_tail - head >= p->sq_entries) return NULL;
+    }
+
+    struct io_uring_sqe* sqe = &p->sqes[p->sq_local_tail & p->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    p->sq_local_tail++;
+    return sqe;
+}
+
+// ======== 接收緩衝區 ========
+static void buf_recycle(NetPoller* p, int bid)
+{
+    struct io_uring_buf* b = &p->br->bufs[p->br_tail & (URING_BUF_COUNT - 1)];
+    b->addr = (uint64_t)(uintptr_t)(p->bufs + (size_t)bid * URING_BUF_SIZE);
+    b->len = URING_BUF_SIZE;
+    b->bid = (uint16_t)bid;
+    p->br_tail++;
+    __atomic_store_n(&p->br->tail, p->br_tail, __ATOMIC_RELEASE);
+    p->recycled = 1;
+}
+
+static void queue_push_buf(struct UringSocket* u, NetPoller* p, int bid, uint32_t len)
+{
+    p->meta[bid].len = len;
+    p->meta[bid].next = -1;
+    if (u->tail >= 0) p->meta[u->tail].next = bid;
+    else u->head = bid;
+    u->tail = bid;
+    u->buf_owner = p;
+}
+
+static void queue_release(struct UringSocket* u)
+{
+    while (u->head >= 0) {
+        int next = u->buf_owner->meta[u->head].next;
+        buf_recycle(u->buf_owner, u->head);
+        u->head = next;
+    }
+    u->tail = -1;
+    u->head_off = 0;
+}
+
+// ======== 就緒列表 ========
+static void link_insert(NetSocket** head, NetSocket* s, UringLink* (*field)(NetSocket*))
+{
+    UringLink* l = field(s);
+    if (l->linked) return;
+    l->prev = NULL;
+    l->next = *head;
+    if (*head) field(*head)->prev = s;
+    *head = s;
+    l->linked = 1;
+}
+
+static void link_remove(NetSocket** head, NetSocket* s, UringLink* (*field)(NetSocket*))
+{
+    UringLink* l = field(s);
+    if (!l->linked) return;
+    if (l->prev) field(l->prev)->next = l->next;
+    else *head = l->next;
+    if (l->next) field(l->next)->prev = l->prev;
+    l->prev = l->next = NULL;
+    l->linked = 0;
+}
+
+static UringLink* ready_link(NetSocket* s)   { return &s->uring->ready; }
+static UringLink* starved_link(NetSocket* s) { return &s->uring->starved; }
+
+static int socket_readable(const struct UringSocket* u)
+{
+    return u->head >= 0 || u->fds_count > 0 || u->eof || u->err;
+}
+
+static void mark_ready(NetSocket* s)
+{
+    struct UringSocket* u = s->uring;
+    if (u->poller && ((u->events & NET_POLL_READ && socket_readable(u)) ||
+                      (u->events & NET_POLL_WRITE && u->writable)))
+        link_insert(&u->poller->ready_head, s, ready_link);
+}
+
+// ======== 操作 ========
+static UringOp* op_start(NetPoller* p, NetSocket* s, UringOpKind kind)
+{
+    UringOp* op = malloc(sizeof(UringOp));
+    if (!op) return NULL;
+
+    struct io_uring_sqe* sqe = uring_get_sqe(p);
+    if (!sqe) {
+        free(op);
+        return NULL;
+    }
+    op->kind = kind;
+    op->s = s;
+    op->p = p;
+    op->seq = p->sq_local_tail - 1;
+    op->cancelled = 0;
+
+    sqe->fd = s->sock;
+    sqe->user_data = (uint64_t)(uintptr_t)op;
+    switch (kind) {
+    case URING_OP_ACCEPT:
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        break;
+    case URING_OP_RECV:
+        sqe->opcode = IORING_OP_RECV;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = URING_BUF_GROUP;
+        break;
+    case URING_OP_POLL:
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->poll32_events = POLLOUT | POLLERR | POLLHUP;
+        sqe->len = IORING_POLL_ADD_MULTI;
+        break;
+    }
+    return op;
+}
+
+static void op_cancel(UringOp* op)
+{
+    if (op->cancelled) return;
+    struct io_uring_sqe* sqe = uring_get_sqe(op->p);
+    if (!sqe) return;
+    op->cancelled = 1;
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t)(uintptr_t)op;
+    sqe->user_data = URING_TAG_IGNORE;
+}
+
+// 按關注的事件發起或取消 multishot 操作
+static void socket_arm(NetSocket* s)
+{
+    struct UringSocket* u = s->uring;
+    NetPoller* p = u->poller;
+    int want_read = p && (u->events & NET_POLL_READ);
+    int want_write = p && (u->events & NET_POLL_WRITE);
+
+    if (u->listening) {
+        if (want_read && !u->accept_op) u->accept_op = op_start(p, s, URING_OP_ACCEPT);
+        else if (!want_read && u->accept_op) op_cancel(u->accept_op);
+        return;
+    }
+
+    if (want_read && !u->recv_op && !u->eof && !u->err && !u->starved.linked)
+        u->recv_op = op_start(p, s, URING_OP_RECV);
+    else if (!want_read && u->recv_op)
+        op_cancel(u->recv_op);
+
+    if (want_write && !u->poll_op) u->poll_op = op_start(p, s, URING_OP_POLL);
+    else if (!want_write && u->poll_op) op_cancel(u->poll_op);
+}
+
+static void on_accept_cqe(NetSocket* s, int res)
+{
+    struct UringSocket* u = s->uring;
+    if (res < 0) {
+        if (res != -ECANCELED) LOG_WARN("io_uring accept failed: %s", strerror(-res));
+        return;
+    }
+
+    if (u->fds_count == u->fds_cap) {
+        int cap = u->fds_cap ? u->fds_cap * 2 : 64;
+        int* nf = malloc(sizeof(int) * cap);
+        if (!nf) {
+            close(res);
+            return;
+        }
+        for (int i = 0; i < u->fds_count; i++)
+            nf[i] = u->fds[(u->fds_head + i) % u->fds_cap];
+        free(u->fds);
+        u->fds = nf;
+        u->fds_cap = cap;
+        u->fds_head = 0;
+    }
+    u->fds[(u->fds_head + u->fds_count) % u->fds_cap] = res;
+    u->fds_count++;
+}
+
+static void on_recv_cqe(NetPoller* p, NetSocket* s, struct io_uring_cqe* cqe)
+{
+    struct UringSocket* u = s->uring;
+    if (cqe->res > 0) {
+        queue_push_buf(u, p, (int)(cqe->flags >> IORING_CQE_BUFFER_SHIFT), (uint32_t)cqe->res);
+    } else if (cqe->res == 0) {
+        u->eof = 1;
+    } else if (cqe->res == -ENOBUFS) {
+        link_insert(&p->starved_head, s, starved_link);
+    } else if (cqe->res != -ECANCELED) {
+        u->err = -cqe->res;
+    }
+}
+
+static void handle_cqe(NetPoller* p, struct io_uring_cqe* cqe)
+{
+    if (cqe->user_data == URING_TAG_IGNORE) return;
+
+    if (cqe->user_data == URING_TAG_WAKE) {
+        struct io_uring_sqe* sqe = uring_get_sqe(p);
+        if (sqe) {
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = p->wakefd;
+            sqe->addr = (uint64_t)(uintptr_t)&p->wake_val;
+            sqe->len = sizeof(p->wake_val);
+            sqe->user_data = URING_TAG_WAKE;
+        }
+        return;
+    }
+
+    UringOp* op = (UringOp*)(uintptr_t)cqe->user_data;
+    NetSocket* s = op->s;
+    int more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+
+    if (!s) {
+        // socket 已關閉：歸還緩衝區，關閉來不及取走的連接
+        if (cqe->flags & IORING_CQE_F_BUFFER)
+            buf_recycle(p, (int)(cqe->flags >> IORING_CQE_BUFFER_SHIFT));
+        if (op->kind == URING_OP_ACCEPT && cqe->res >= 0)
+            close(cqe->res);
+        if (!more) free(op);
+        return;
+    }
+
+    struct UringSocket* u = s->uring;
+    switch (op->kind) {
+    case URING_OP_ACCEPT:
+        on_accept_cqe(s, cqe->res);
+        if (!more) u->accept_op = NULL;
+        break;
+    case URING_OP_RECV:
+        on_recv_cqe(p, s, cqe);
+        if (!more) u->recv_op = NULL;
+        break;
+    case URING_OP_POLL:
+        if (cqe->res > 0) u->writable = 1;
+        else if (cqe->res < 0 && cqe->res != -ECANCELED) u->err = -cqe->res;
+        if (!more) u->poll_op = NULL;
+        break;
+    }
+
+    if (!more) {
+        free(op);
+        socket_arm(s);          // 被取消或意外終止的操作按當前關注的事件重新發起
+    }
+    mark_ready(s);
+}
+
+// ======== Poller ========
+NetPoller* net_poller_create(void)
+{
+    NetPoller* p = calloc(1, sizeof(NetPoller));
+    if (!p) return NULL;
+    p->wakefd = -1;
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+    params.cq_entries = URING_ENTRIES * 4;
+
+    p->fd = uring_setup(URING_ENTRIES, &params);
+    if (p->fd < 0) {
+        LOG_ERROR("io_uring_setup failed: %s", strerror(errno));
+        free(p);
+        return NULL;
+    }
+    if (!(params.features & IORING_FEAT_EXT_ARG) || !(params.features & IORING_FEAT_NODROP)) {
+        LOG_ERROR("io_uring backend requires a newer kernel");
+        close(p->fd);
+        free(p);
+        return NULL;
+    }
+
+    p->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    p->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    p->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    p->sq_ptr = mmap(NULL, p->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, p->fd, IORING_OFF_SQ_RING);
+    p->cq_ptr = mmap(NULL, p->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, p->fd, IORING_OFF_CQ_RING);
+    p->sqes = mmap(NULL, p->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, p->fd, IORING_OFF_SQES);
+    p->br_size = sizeof(struct io_uring_buf) * URING_BUF_COUNT;
+    p->br = mmap(NULL, p->br_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    p->bufs = malloc((size_t)URING_BUF_COUNT * URING_BUF_SIZE);
+    p->wakefd = eventfd(0, EFD_CLOEXEC);
+
+    if (p->sq_ptr == MAP_FAILED || p->cq_ptr == MAP_FAILED || p->sqes == MAP_FAILED ||
+        p->br == MAP_FAILED || !p->bufs || p->wakefd < 0) {
+        LOG_ERROR("Failed to map io_uring queues");
+        if (p->sq_ptr == MAP_FAILED) p->sq_ptr = NULL;
+        if (p->cq_ptr == MAP_FAILED) p->cq_ptr = NULL;
+        if (p->sqes == MAP_FAILED) p->sqes = NULL;
+        if (p->br == MAP_FAILED) p->br = NULL;
+        net_poller_free(p);
+        return NULL;
+    }
+
+    char* sq = p->sq_ptr;
+    p->sq_head = (unsigned*)(sq + params.sq_off.head);
+    p->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    p->sq_array = (unsigned*)(sq + params.sq_off.array);
+    p->sq_mask = *(unsigned*)(sq + params.sq_off.ring_mask);
+    p->sq_entries = *(unsigned*)(sq + params.sq_off.ring_entries);
+    p->sq_local_tail = p->sq_submitted = *p->sq_tail;
+    for (unsigned i = 0; i < p->sq_entries; i++)
+        p->sq_array[i] = i;
+
+    char* cq = p->cq_ptr;
+    p->cq_head = (unsigned*)(cq + params.cq_off.head);
+    p->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    p->cq_mask = *(unsigned*)(cq + params.cq_off.ring_mask);
+    p->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)p->br;
+    reg.ring_entries = URING_BUF_COUNT;
+    reg.bgid = URING_BUF_GROUP;
+    if (uring_register(p->fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+        LOG_ERROR("io_uring buffer ring registration failed: %s", strerror(errno));
+        net_poller_free(p);
+        return NULL;
+    }
+    for (int i = 0; i < URING_BUF_COUNT; i++)
+        buf_recycle(p, i);
+
+    // eventfd 用於跨綫程喚醒
+    struct io_uring_sqe* sqe = uring_get_sqe(p);
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = p->wakefd;
+    sqe->addr = (uint64_t)(uintptr_t)&p->wake_val;
+    sqe->len = sizeof(p->wake_val);
+    sqe->user_data = URING_TAG_WAKE;
+    return p;
+}
+
+static struct UringSocket* socket_state_new(NetSocket* s, int listening)
+{
+    struct UringSocket* u = calloc(1, sizeof(struct UringSocket));
+    if (!u) return NULL;
+    u->head = u->tail = -1;
+    u->listening = listening;
+    s->uring = u;
+    return u;
+}
+
+static struct UringSocket* socket_state(NetSocket* s)
+{
+    if (s->uring) return s->uring;
+
+    // 監聽 socket 由 net_tcp_listen 創建，首次註冊時確認類型
+    int listening = 0;
+    socklen_t len = sizeof(listening);
+    if (getsockopt(s->sock, SOL_SOCKET, SO_ACCEPTCONN, &listening, &len) != 0)
+        listening = 0;
+    return socket_state_new(s, listening);
+}
+
+int net_poller_add(NetPoller* p, NetSocket* s, int events, void* udata)
+{
+    if (!p || !s) return -1;
+
+    struct UringSocket* u = socket_state(s);
+    if (!u || u->poller) return -1;
+
+    u->poller = p;
+    u->udata = udata;
+    u->events = events;
+    u->writable = 0;
+    socket_arm(s);
+    mark_ready(s);      // 之前收到但未讀取的數據
+    return 0;
+}
+
+int net_poller_mod(NetPoller* p, NetSocket* s, int events, void* udata)
+{
+    if (!p || !s || !s->uring || s->uring->poller != p) return -1;
+
+    struct UringSocket* u = s->uring;
+    if (!(events & NET_POLL_WRITE)) u->writable = 0;
+    u->udata = udata;
+    u->events = events;
+    socket_arm(s);
+    mark_ready(s);
+    return 0;
+}
+
+int net_poller_del(NetPoller* p, NetSocket* s)
+{
+    if (!p || !s || !s->uring || s->uring->poller != p) return -1;
+
+    struct UringSocket* u = s->uring;
+    u->events = 0;
+    socket_arm(s);
+    link_remove(&p->ready_head, s, ready_link);
+    link_remove(&p->starved_head, s, starved_link);
+    u->poller = NULL;
+    u->udata = NULL;
+    u->writable = 0;
+    return 0;
+}
+
+int net_poller_wait(NetPoller* p, NetPollEvent* events, int max_events, int timeout_ms)
+{
+    if (!p || !events || max_events <= 0) return -1;
+
+    // 有緩衝區歸還後，重新為耗盡時停下的連接發起 recv
+    if (p->recycled) {
+        p->recycled = 0;
+        while (p->starved_head) {
+            NetSocket* s = p->starved_head;
+            link_remove(&p->starved_head, s, starved_link);
+            socket_arm(s);
+        }
+    }
+
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    if (p->ready_head) timeout_ms = 0;
+    if (timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000;
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+    }
+
+    unsigned head = *p->cq_head;
+    int have_cqes = head != __atomic_load_n(p->cq_tail, __ATOMIC_ACQUIRE);
+    unsigned min_complete = (timeout_ms == 0 || have_cqes) ? 0 : 1;
+    if (uring_submit(p, min_complete, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg)) != 0)
+        return -1;
+
+    // 收割完成事件；處理時可能填寫新的 SQE，留到下一次 wait 提交
+    unsigned tail = __atomic_load_n(p->cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        handle_cqe(p, &p->cqes[head & p->cq_mask]);
+        head++;
+        if (head == tail) {
+            __atomic_store_n(p->cq_head, head, __ATOMIC_RELEASE);
+            tail = __atomic_load_n(p->cq_tail, __ATOMIC_ACQUIRE);
+        }
+    }
+    __atomic_store_n(p->cq_head, head, __ATOMIC_RELEASE);
+
+    // 可讀按水平觸發報告：隊列未讀完的 socket 留在就緒列表中；可寫每次就緒只報告一次
+    int out = 0;
+    NetSocket* s = p->ready_head;
+    while (s && out < max_events) {
+        NetSocket* next = s->uring->ready.next;
+        struct UringSocket* u = s->uring;
+
+        int ev = 0;
+        if ((u->events & NET_POLL_READ) && socket_readable(u)) ev |= NET_POLL_READ;
+        if ((u->events & NET_POLL_WRITE) && u->writable) ev |= NET_POLL_WRITE;
+        if (u->err) ev |= NET_POLL_ERROR;
+        u->writable = 0;
+
+        if (!(ev & NET_POLL_READ)) link_remove(&p->ready_head, s, ready_link);
+        if (ev) {
+            events[out].udata = u->udata;
+            events[out].events = ev;
+            out++;
+        }
+        s = next;
+    }
+    return out;
+}
+
+void net_poller_wakeup(NetPoller* p)
+{
+    if (!p) return;
+    uint64_t one = 1;
+    ssize_t r = write(p->wakefd, &one, sizeof(one));
+    (void)r;
+}
+
+void net_poller_free(NetPoller* p)
+{
+    if (!p) return;
+    if (p->wakefd >= 0) close(p->wakefd);
+    if (p->fd >= 0) close(p->fd);
+    if (p->sq_ptr) munmap(p->sq_ptr, p->sq_size);
+    if (p->cq_ptr) munmap(p->cq_ptr, p->cq_size);
+    if (p->sqes) munmap(p->sqes, p->sqes_size);
+    if (p->br) munmap(p->br, p->br_size);
+    free(p->bufs);
+    free(p);
+}
+
+// ======== 網絡 ========
+NetSocket* net_accept(NetSocket* server)
+{
+    if (!server) return NULL;
+
+    struct UringSocket* u = server->uring;
+    int client_fd;
+    if (u && u->fds_count > 0) {
+        client_fd = u->fds[u->fds_head];
+        u->fds_head = (u->fds_head + 1) % u->fds_cap;
+        u->fds_count--;
+    } else if (u && u->accept_op) {
+        return NULL;            // 新連接會由 multishot accept 送達
+    } else {
+        client_fd = accept(server->sock, NULL, NULL);
+        if (client_fd < 0)
+            return NULL;
+    }
+
+    NetSocket* c = calloc(1, sizeof(NetSocket));
+    if (!c || !socket_state_new(c, 0)) {
+        free(c);
+        close(client_fd);
+        return NULL;
+    }
+    c->sock = client_fd;
+    return c;
+}
+
+int net_recv(NetSocket* s, void* buf, int len)
+{
+    if (!s) return -1;
+
+    struct UringSocket* u = s->uring;
+    if (u && u->head >= 0) {
+        // 從已收到的緩衝區拷出，讀完的緩衝區歸還給內核
+        NetPoller* p = u->buf_owner;
+        int copied = 0;
+        while (copied < len && u->head >= 0) {
+            UringBuf* b = &p->meta[u->head];
+            uint32_t n = b->len - u->head_off;
+            if (n > (uint32_t)(len - copied)) n = (uint32_t)(len - copied);
+            memcpy((char*)buf + copied, p->bufs + (size_t)u->head * URING_BUF_SIZE + u->head_off, n);
+            copied += (int)n;
+            u->head_off += n;
+            if (u->head_off == b->len) {
+                int next = b->next;
+                buf_recycle(p, u->head);
+                u->head = next;
+                u->head_off = 0;
+                if (next < 0) u->tail = -1;
+            }
+        }
+        return copied;
+    }
+
+    if (u && u->err) {
+        errno = u->err;
+        return -1;
+    }
+    if (u && u->eof) return 0;
+    if (u && u->recv_op) return NET_WOULD_BLOCK;   // 數據會由 multishot recv 送達
+
+    ssize_t n;
+    do {
+        n = recv(s->sock, buf, len, 0);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return NET_WOULD_BLOCK;
+    return (int)n;
+}
+
+void net_close(NetSocket* s)
+{
+    if (!s) return;
+
+    struct UringSocket* u = s->uring;
+    if (u) {
+        if (u->poller) net_poller_del(u->poller, s);
+
+        // 在途操作與 socket 解綁，之後的結果由 poller 丟棄
+        UringOp* ops[3] = { u->accept_op, u->recv_op, u->poll_op };
+        NetPoller* unsubmitted = NULL;
+        for (int i = 0; i < 3; i++) {
+            if (!ops[i]) continue;
+            ops[i]->s = NULL;
+            op_cancel(ops[i]);
+            if ((int)(ops[i]->seq - ops[i]->p->sq_submitted) >= 0)
+                unsubmitted = ops[i]->p;
+        }
+
+        // 尚未提交的操作只記錄了 fd 號，關閉前必須先提交，否則可能作用到復用該 fd 的新連接
+        if (unsubmitted)
+            uring_submit(unsubmitted, 0, 0, NULL, 0);
+
+        queue_release(u);
+        for (int i = 0; i < u->fds_count; i++)
+            close(u->fds[(u->fds_head + i) % u->fds_cap]);
+        free(u->fds);
+        free(u);
+    }
+
+    close(s->sock);
+    free(s);
+}
@@ -1,28 +1,42 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // pthread_setaffinity_np
+#endif
+
 #include "utils/platform/platform.h"
+#include "utils/platform/platform_posix_internal.h"
 #include "utils/log/logger.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <fcntl.h>
 
 #include <pthread.h>
+#include <signal.h>
 #include <time.h>
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
 #include <sys/stat.h>
+#include <poll.h>
 
-struct NetSocket {
-    int sock;
-};
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/inotify.h>
+#endif
 
 int net_init(void)
 {
     LOG_INFO("Server starting...");
+    // 對端提前關閉時 send / sendfile 返回 EPIPE，而不是終止進程
+    signal(SIGPIPE, SIG_IGN);
     return 0;
 }
 
@@ -32,6 +46,11 @@ void net_shutdown(void)
 }
 
 NetSocket* net_tcp_listen(const char* ip, uint16_t port)
+{
+    return net_tcp_listen_ex(ip, port, 0);
+}
+
+NetSocket* net_tcp_listen_ex(const char* ip, uint16_t port, int flags)
 {
     int fd = socket(AF_INET, SOCK_STREAM, 0);
     if (fd < 0)
@@ -40,6 +59,18 @@ NetSocket* net_tcp_listen(const char* ip, uint16_t port)
     int opt = 1;
     setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
 
+    if (flags & NET_LISTEN_REUSEPORT) {
+#ifdef SO_REUSEPORT
+        if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) != 0) {
+            close(fd);
+            return NULL;
+        }
+#else
+        close(fd);
+        return NULL;
+#endif
+    }
+
     struct sockaddr_in addr;
     memset(&addr, 0, sizeof(addr));
     addr.sin_family = AF_INET;
@@ -56,7 +87,11 @@ NetSocket* net_tcp_listen(const char* ip, uint16_t port)
         return NULL;
     }
 
-    NetSocket* s = malloc(sizeof(NetSocket));
+    NetSocket* s = calloc(1, sizeof(NetSocket));
+    if (!s) {
+        close(fd);
+        return NULL;
+    }
     s->sock = fd;
 
     LOG_INFO("Listening on %s:%d", ip, port);
@@ -64,6 +99,8 @@ NetSocket* net_tcp_listen(const char* ip, uint16_t port)
     return s;
 }
 
+// 啓用 io_uring 後端時，accept / recv / close 和事件輪詢由 platform_linux_uring.c 實現
+#ifndef CWEB_IO_URING
 NetSocket* net_accept(NetSocket* server)
 {
     if (!server) return NULL;
@@ -76,17 +113,66 @@ NetSocket* net_accept(NetSocket* server)
     c->sock = client_fd;
     return c;
 }
+#endif
 
 int net_send(NetSocket* s, const void* buf, int len)
 {
     if (!s) return -1;
-    return (int)send(s->sock, buf, len, 0);
+    ssize_t n;
+    do {
+        n = send(s->sock, buf, len, 0);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return NET_WOULD_BLOCK;
+    return (int)n;
 }
 
+#ifndef CWEB_IO_URING
 int net_recv(NetSocket* s, void* buf, int len)
 {
     if (!s) return -1;
-    return (int)recv(s->sock, buf, len, 0);
+    ssize_t n;
+    do {
+        n = recv(s->sock, buf, len, 0);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return NET_WOULD_BLOCK;
+    return (int)n;
+}
+#endif
+
+int64_t net_sendv(NetSocket* s, const NetIoVec* iov, int count)
+{
+    if (!s || !iov || count <= 0) return -1;
+    if (count > NET_IOV_MAX) count = NET_IOV_MAX;
+
+    struct iovec vec[NET_IOV_MAX];
+    for (int i = 0; i < count; i++) {
+        vec[i].iov_base = (void*)iov[i].base;
+        vec[i].iov_len  = iov[i].len;
+    }
+
+    ssize_t n;
+    do {
+        n = writev(s->sock, vec, count);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return NET_WOULD_BLOCK;
+    return (int64_t)n;
+}
+
+int net_set_nonblocking(NetSocket* s, int enable)
+{
+    if (!s) return -1;
+
+    int flags = fcntl(s->sock, F_GETFL, 0);
+    if (flags < 0) return -1;
+
+    flags = enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return fcntl(s->sock, F_SETFL, flags) < 0 ? -1 : 0;
 }
 
 const char* net_get_ip(NetSocket* s)
@@ -132,12 +218,283 @@ uint16_t net_get_port(NetSocket* s)
     return 0;
 }
 
+#ifndef CWEB_IO_URING
 void net_close(NetSocket* s)
 {
     if (!s) return;
     close(s->sock);
     free(s);
 }
+#endif
+
+// ======== 事件輪詢 ========
+#if defined(CWEB_IO_URING)
+// 見 platform_linux_uring.c
+#elif defined(__linux__)
+
+struct NetPoller {
+    int epfd;
+    int wakefd;
+    struct epoll_event* buf;
+    int buf_cap;
+};
+
+static uint32_t to_epoll_events(int events)
+{
+    uint32_t ev = 0;
+    if (events & NET_POLL_READ)  ev |= EPOLLIN | EPOLLRDHUP;
+    if (events & NET_POLL_WRITE) ev |= EPOLLOUT;
+    return ev;
+}
+
+NetPoller* net_poller_create(void)
+{
+    NetPoller* p = malloc(sizeof(NetPoller));
+    if (!p) return NULL;
+
+    p->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (p->epfd < 0) {
+        free(p);
+        return NULL;
+    }
+
+    // eventfd 用於跨綫程喚醒，data.ptr 指向 poller 自身
+    p->wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = p;
+    if (p->wakefd < 0 || epoll_ctl(p->epfd, EPOLL_CTL_ADD, p->wakefd, &ev) != 0) {
+        if (p->wakefd >= 0) close(p->wakefd);
+        close(p->epfd);
+        free(p);
+        return NULL;
+    }
+    p->buf = NULL;
+    p->buf_cap = 0;
+    return p;
+}
+
+static int poller_ctl(NetPoller* p, int op, NetSocket* s, int events, void* udata)
+{
+    if (!p || !s) return -1;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = to_epoll_events(events);
+    ev.data.ptr = udata;
+    return epoll_ctl(p->epfd, op, s->sock, &ev);
+}
+
+int net_poller_add(NetPoller* p, NetSocket* s, int events, void* udata)
+{
+    return poller_ctl(p, EPOLL_CTL_ADD, s, events, udata);
+}
+
+int net_poller_mod(NetPoller* p, NetSocket* s, int events, void* udata)
+{
+    return poller_ctl(p, EPOLL_CTL_MOD, s, events, udata);
+}
+
+int net_poller_del(NetPoller* p, NetSocket* s)
+{
+    return poller_ctl(p, EPOLL_CTL_DEL, s, 0, NULL);
+}
+
+int net_poller_wait(NetPoller* p, NetPollEvent* events, int max_events, int timeout_ms)
+{
+    if (!p || !events || max_events <= 0) return -1;
+
+    if (p->buf_cap < max_events) {
+        struct epoll_event* nb = realloc(p->buf, sizeof(struct epoll_event) * max_events);
+        if (!nb) return -1;
+        p->buf = nb;
+        p->buf_cap = max_events;
+    }
+
+    int n = epoll_wait(p->epfd, p->buf, max_events, timeout_ms);
+    if (n < 0) return errno == EINTR ? 0 : -1;
+
+    int out = 0;
+    for (int i = 0; i < n; i++) {
+        if (p->buf[i].data.ptr == p) {
+            uint64_t v;
+            while (read(p->wakefd, &v, sizeof(v)) > 0) {}
+            continue;
+        }
+
+        uint32_t ev = p->buf[i].events;
+        events[out].udata = p->buf[i].data.ptr;
+        events[out].events = 0;
+        if (ev & EPOLLIN)  events[out].events |= NET_POLL_READ;
+        if (ev & EPOLLOUT) events[out].events |= NET_POLL_WRITE;
+        if (ev & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) events[out].events |= NET_POLL_ERROR;
+        out++;
+    }
+    return out;
+}
+
+void net_poller_wakeup(NetPoller* p)
+{
+    if (!p) return;
+    uint64_t one = 1;
+    ssize_t r = write(p->wakefd, &one, sizeof(one));
+    (void)r;
+}
+
+void net_poller_free(NetPoller* p)
+{
+    if (!p) return;
+    close(p->wakefd);
+    close(p->epfd);
+    free(p->buf);
+    free(p);
+}
+
+#else
+
+// 非 Linux 的 POSIX 系統退化為 poll()，fds[0] 固定為喚醒管道
+struct NetPoller {
+    struct pollfd* fds;
+    void** udata;
+    int count;
+    int cap;
+    int wake[2];
+};
+
+NetPoller* net_poller_create(void)
+{
+    NetPoller* p = calloc(1, sizeof(NetPoller));
+    if (!p) return NULL;
+
+    p->cap = 64;
+    p->fds = malloc(sizeof(struct pollfd) * p->cap);
+    p->udata = malloc(sizeof(void*) * p->cap);
+    if (!p->fds || !p->udata || pipe(p->wake) != 0) {
+        free(p->fds);
+        free(p->udata);
+        free(p);
+        return NULL;
+    }
+    fcntl(p->wake[0], F_SETFL, O_NONBLOCK);
+    fcntl(p->wake[1], F_SETFL, O_NONBLOCK);
+
+    p->fds[0].fd = p->wake[0];
+    p->fds[0].events = POLLIN;
+    p->fds[0].revents = 0;
+    p->udata[0] = NULL;
+    p->count = 1;
+    return p;
+}
+
+static int poller_find(NetPoller* p, int fd)
+{
+    for (int i = 1; i < p->count; i++) {
+        if (p->fds[i].fd == fd) return i;
+    }
+    return -1;
+}
+
+static short to_poll_events(int events)
+{
+    short ev = 0;
+    if (events & NET_POLL_READ)  ev |= POLLIN;
+    if (events & NET_POLL_WRITE) ev |= POLLOUT;
+    return ev;
+}
+
+int net_poller_add(NetPoller* p, NetSocket* s, int events, void* udata)
+{
+    if (!p || !s || poller_find(p, s->sock) >= 0) return -1;
+
+    if (p->count == p->cap) {
+        int cap = p->cap ? p->cap * 2 : 64;
+        struct pollfd* nf = realloc(p->fds, sizeof(struct pollfd) * cap);
+        if (!nf) return -1;
+        p->fds = nf;
+        void** nu = realloc(p->udata, sizeof(void*) * cap);
+        if (!nu) return -1;
+        p->udata = nu;
+        p->cap = cap;
+    }
+
+    p->fds[p->count].fd = s->sock;
+    p->fds[p->count].events = to_poll_events(events);
+    p->fds[p->count].revents = 0;
+    p->udata[p->count] = udata;
+    p->count++;
+    return 0;
+}
+
+int net_poller_mod(NetPoller* p, NetSocket* s, int events, void* udata)
+{
+    if (!p || !s) return -1;
+    int i = poller_find(p, s->sock);
+    if (i < 0) return -1;
+
+    p->fds[i].events = to_poll_events(events);
+    p->udata[i] = udata;
+    return 0;
+}
+
+int net_poller_del(NetPoller* p, NetSocket* s)
+{
+    if (!p || !s) return -1;
+    int i = poller_find(p, s->sock);
+    if (i < 0) return -1;
+
+    p->count--;
+    p->fds[i] = p->fds[p->count];
+    p->udata[i] = p->udata[p->count];
+    return 0;
+}
+
+int net_poller_wait(NetPoller* p, NetPollEvent* events, int max_events, int timeout_ms)
+{
+    if (!p || !events || max_events <= 0) return -1;
+
+    int n = poll(p->fds, p->count, timeout_ms);
+    if (n < 0) return errno == EINTR ? 0 : -1;
+
+    if (p->fds[0].revents) {
+        char drain[64];
+        while (read(p->wake[0], drain, sizeof(drain)) > 0) {}
+    }
+
+    int out = 0;
+    for (int i = 1; i < p->count && out < max_events; i++) {
+        short ev = p->fds[i].revents;
+        if (!ev) continue;
+
+        events[out].udata = p->udata[i];
+        events[out].events = 0;
+        if (ev & POLLIN)  events[out].events |= NET_POLL_READ;
+        if (ev & POLLOUT) events[out].events |= NET_POLL_WRITE;
+        if (ev & (POLLERR | POLLHUP | POLLNVAL)) events[out].events |= NET_POLL_ERROR;
+        out++;
+    }
+    return out;
+}
+
+void net_poller_wakeup(NetPoller* p)
+{
+    if (!p) return;
+    char c = 1;
+    ssize_t r = write(p->wake[1], &c, 1);
+    (void)r;
+}
+
+void net_poller_free(NetPoller* p)
+{
+    if (!p) return;
+    close(p->wake[0]);
+    close(p->wake[1]);
+    free(p->fds);
+    free(p->udata);
+    free(p);
+}
+
+#endif
 
 struct Thread {
     pthread_t thread;
@@ -201,6 +558,26 @@ void thread_free(Thread* t)
     free(t);
 }
 
+int thread_set_affinity(Thread* t, int cpu)
+{
+    if (!t || cpu < 0) return -1;
+
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(t->thread, sizeof(set), &set) == 0 ? 0 : -1;
+#else
+    return -1;
+#endif
+}
+
+int cpu_count(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
 void thread_sleep(long ms)
 {
     if (ms <= 0) return;
@@ -241,7 +618,7 @@ void mutex_free(Mutex* m)
 
 struct Cond {
     pthread_cond_t cond;
-} Cond;
+};
 
 Cond* cond_create(void) {
     Cond* c = malloc(sizeof(Cond));
@@ -278,7 +655,186 @@ int mkdirectory(const char* path)
     return -1;
 }
 
+struct FileHandle {
+    int fd;
+};
+
+FileHandle* file_open_read(const char* path, uint64_t* size)
+{
+    if (!path) return NULL;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return NULL;
+    }
+
+    FileHandle* f = malloc(sizeof(FileHandle));
+    if (!f) {
+        close(fd);
+        return NULL;
+    }
+    f->fd = fd;
+    if (size) *size = (uint64_t)st.st_size;
+    return f;
+}
+
+void file_close(FileHandle* f)
+{
+    if (!f) return;
+    close(f->fd);
+    free(f);
+}
+
+int64_t file_read(FileHandle* f, void* buf, size_t len, uint64_t offset)
+{
+    if (!f) return -1;
+    ssize_t n;
+    do {
+        n = pread(f->fd, buf, len, (off_t)offset);
+    } while (n < 0 && errno == EINTR);
+    return (int64_t)n;
+}
+
+static void stat_result(const struct stat* st, uint64_t* size, int64_t* mtime_ns)
+{
+    if (size) *size = (uint64_t)st->st_size;
+#if defined(__APPLE__)
+    if (mtime_ns) *mtime_ns = (int64_t)st->st_mtimespec.tv_sec * 1000000000 + st->st_mtimespec.tv_nsec;
+#else
+    if (mtime_ns) *mtime_ns = (int64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+#endif
+}
+
+int file_stat(const char* path, uint64_t* size, int64_t* mtime_ns)
+{
+    struct stat st;
+    if (!path || stat(path, &st) != 0 || !S_ISREG(st.st_mode)) return -1;
+    stat_result(&st, size, mtime_ns);
+    return 0;
+}
+
+int file_fstat(FileHandle* f, uint64_t* size, int64_t* mtime_ns)
+{
+    struct stat st;
+    if (!f || fstat(f->fd, &st) != 0 || !S_ISREG(st.st_mode)) return -1;
+    stat_result(&st, size, mtime_ns);
+    return 0;
+}
+
+#if defined(__linux__)
+struct FileWatcher {
+    int fd;
+    // 一次 read 讀到但還沒返回給調用方的事件
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    size_t off;
+    size_t len;
+};
+
+FileWatcher* file_watcher_create(void)
+{
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return NULL;
+    FileWatcher* w = malloc(sizeof(FileWatcher));
+    if (!w) {
+        close(fd);
+        return NULL;
+    }
+    w->fd = fd;
+    w->off = 0;
+    w->len = 0;
+    return w;
+}
+
+int file_watcher_add(FileWatcher* w, const char* path)
+{
+    if (!w || !path) return -1;
+    return inotify_add_watch(w->fd, path, IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE |
+                                          IN_MOVE_SELF | IN_DELETE_SELF);
+}
+
+void file_watcher_remove(FileWatcher* w, int id)
+{
+    if (w && id >= 0) inotify_rm_watch(w->fd, id);
+}
+
+int file_watcher_wait(FileWatcher* w, int* ids, int max, int timeout_ms)
+{
+    if (!w || max <= 0) return -1;
+
+    // 上次沒返回完的事件先返回，不需要等待
+    if (w->off >= w->len) {
+        struct pollfd pfd = { w->fd, POLLIN, 0 };
+        int r = poll(&pfd, 1, timeout_ms);
+        if (r <= 0) return r < 0 && errno != EINTR ? -1 : 0;
+
+        // 事件長度可變，按 inotify_event 對齊讀取；內核只返回完整的事件
+        ssize_t n = read(w->fd, w->buf, sizeof(w->buf));
+        if (n <= 0) return n < 0 && errno != EAGAIN && errno != EINTR ? -1 : 0;
+        w->off = 0;
+        w->len = (size_t)n;
+    }
+
+    int count = 0;
+    while (w->off < w->len && count < max) {
+        const struct inotify_event* ev = (const struct inotify_event*)(w->buf + w->off);
+        // IN_Q_OVERFLOW 的監視號本身就是 -1
+        ids[count++] = (ev->mask & IN_Q_OVERFLOW) ? FILE_WATCH_OVERFLOW : ev->wd;
+        w->off += sizeof(struct inotify_event) + ev->len;
+    }
+    return count;
+}
+
+void file_watcher_free(FileWatcher* w)
+{
+    if (!w) return;
+    close(w->fd);
+    free(w);
+}
+#else
+FileWatcher* file_watcher_create(void) { return NULL; }
+int file_watcher_add(FileWatcher* w, const char* path) { (void)w; (void)path; return -1; }
+void file_watcher_remove(FileWatcher* w, int id) { (void)w; (void)id; }
+int file_watcher_wait(FileWatcher* w, int* ids, int max, int timeout_ms) { (void)w; (void)ids; (void)max; (void)timeout_ms; return -1; }
+void file_watcher_free(FileWatcher* w) { (void)w; }
+#endif
+
+int64_t net_sendfile(NetSocket* s, FileHandle* f, uint64_t offset, size_t count)
+{
+    if (!s || !f) return -1;
+
+#if defined(__linux__)
+    off_t off = (off_t)offset;
+    ssize_t n;
+    do {
+        n = sendfile(s->sock, f->fd, &off, count);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return NET_WOULD_BLOCK;
+    return (int64_t)n;
+#else
+    // 其他 POSIX 系統：pread + send
+    char buf[64 * 1024];
+    if (count > sizeof(buf)) count = sizeof(buf);
+
+    ssize_t r = pread(f->fd, buf, count, (off_t)offset);
+    if (r <= 0) return r < 0 ? -1 : 0;
+    return net_send(s, buf, (int)r);
+#endif
+}
+
 int localtime_safe(const time_t* t, struct tm* out_tm)
 {
     return localtime_r(t, out_tm) ? 0 : -1;
+}
+
+uint64_t time_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
 }
\ No newline at end of file
@@ -0,0 +1,15 @@
+#ifndef PLATFORM_POSIX_INTERNAL_H
+#define PLATFORM_POSIX_INTERNAL_H
+
+// POSIX 後端與 io_uring 後端（platform_linux_uring.c）共用的 socket 結構
+
+struct UringSocket;
+
+struct NetSocket {
+    int sock;
+#ifdef CWEB_IO_URING
+    struct UringSocket* uring;  // 已收到的數據和在途的 io_uring 操作，首次註冊時創建
+#endif
+};
+
+#endif
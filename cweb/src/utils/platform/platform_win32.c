@@ -6,6 +6,7 @@
 #include <WinSock2.h>
 #include <WS2tcpip.h>
 #include <direct.h>
+#include <stdio.h>
 
 struct NetSocket
 {
@@ -26,6 +27,14 @@ void net_shutdown(void)
 
 NetSocket* net_tcp_listen(const char* ip, uint16_t port)
 {
+    return net_tcp_listen_ex(ip, port, 0);
+}
+
+NetSocket* net_tcp_listen_ex(const char* ip, uint16_t port, int flags)
+{
+    // Windows 沒有按連接分流的 SO_REUSEPORT
+    if (flags & NET_LISTEN_REUSEPORT) return NULL;
+
     SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (s == INVALID_SOCKET) return NULL;
 
@@ -56,11 +65,42 @@ NetSocket* net_accept(NetSocket* server)
 
 int net_send(NetSocket* s, const void* buf, int len)
 {
-    return send(s->sock, buf, len, 0);
+    int n = send(s->sock, buf, len, 0);
+    if (n == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK)
+        return NET_WOULD_BLOCK;
+    return n;
 }
 int net_recv(NetSocket* s, void* buf, int len)
 {
-    return recv(s->sock, buf, len, 0);
+    int n = recv(s->sock, buf, len, 0);
+    if (n == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK)
+        return NET_WOULD_BLOCK;
+    return n;
+}
+
+int64_t net_sendv(NetSocket* s, const NetIoVec* iov, int count)
+{
+    if (!s || !iov || count <= 0) return -1;
+    if (count > NET_IOV_MAX) count = NET_IOV_MAX;
+
+    WSABUF bufs[NET_IOV_MAX];
+    for (int i = 0; i < count; i++) {
+        bufs[i].buf = (CHAR*)iov[i].base;
+        bufs[i].len = (ULONG)iov[i].len;
+    }
+
+    DWORD sent = 0;
+    if (WSASend(s->sock, bufs, (DWORD)count, &sent, 0, NULL, NULL) == SOCKET_ERROR) {
+        return WSAGetLastError() == WSAEWOULDBLOCK ? NET_WOULD_BLOCK : -1;
+    }
+    return (int64_t)sent;
+}
+
+int net_set_nonblocking(NetSocket* s, int enable)
+{
+    if (!s) return -1;
+    u_long mode = enable ? 1 : 0;
+    return ioctlsocket(s->sock, FIONBIO, &mode) == 0 ? 0 : -1;
 }
 
 
@@ -115,6 +155,166 @@ void net_close(NetSocket* s)
     free(s);
 }
 
+// ======== 事件輪詢 ========
+// Windows 上用 WSAPoll 實現，fds[0] 固定為連向自身的 UDP 喚醒 socket
+struct NetPoller
+{
+    WSAPOLLFD* fds;
+    void** udata;
+    int count;
+    int cap;
+    SOCKET wake;
+};
+
+NetPoller* net_poller_create(void)
+{
+    NetPoller* p = (NetPoller*)calloc(1, sizeof(NetPoller));
+    if (!p) return NULL;
+
+    p->wake = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (p->wake == INVALID_SOCKET) {
+        free(p);
+        return NULL;
+    }
+
+    struct sockaddr_in addr = {0};
+    int addr_len = sizeof(addr);
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    u_long nb = 1;
+    if (bind(p->wake, (struct sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR ||
+        getsockname(p->wake, (struct sockaddr*)&addr, &addr_len) == SOCKET_ERROR ||
+        connect(p->wake, (struct sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR ||
+        ioctlsocket(p->wake, FIONBIO, &nb) != 0) {
+        closesocket(p->wake);
+        free(p);
+        return NULL;
+    }
+
+    p->cap = 64;
+    p->fds = (WSAPOLLFD*)malloc(sizeof(WSAPOLLFD) * p->cap);
+    p->udata = (void**)malloc(sizeof(void*) * p->cap);
+    if (!p->fds || !p->udata) {
+        closesocket(p->wake);
+        free(p->fds);
+        free(p->udata);
+        free(p);
+        return NULL;
+    }
+
+    p->fds[0].fd = p->wake;
+    p->fds[0].events = POLLRDNORM;
+    p->fds[0].revents = 0;
+    p->udata[0] = NULL;
+    p->count = 1;
+    return p;
+}
+
+static int poller_find(NetPoller* p, SOCKET sock)
+{
+    for (int i = 1; i < p->count; i++) {
+        if (p->fds[i].fd == sock) return i;
+    }
+    return -1;
+}
+
+static SHORT to_poll_events(int events)
+{
+    SHORT ev = 0;
+    if (events & NET_POLL_READ)  ev |= POLLRDNORM;
+    if (events & NET_POLL_WRITE) ev |= POLLWRNORM;
+    return ev;
+}
+
+int net_poller_add(NetPoller* p, NetSocket* s, int events, void* udata)
+{
+    if (!p || !s || poller_find(p, s->sock) >= 0) return -1;
+
+    if (p->count == p->cap) {
+        int cap = p->cap ? p->cap * 2 : 64;
+        WSAPOLLFD* nf = (WSAPOLLFD*)realloc(p->fds, sizeof(WSAPOLLFD) * cap);
+        if (!nf) return -1;
+        p->fds = nf;
+        void** nu = (void**)realloc(p->udata, sizeof(void*) * cap);
+        if (!nu) return -1;
+        p->udata = nu;
+        p->cap = cap;
+    }
+
+    p->fds[p->count].fd = s->sock;
+    p->fds[p->count].events = to_poll_events(events);
+    p->fds[p->count].revents = 0;
+    p->udata[p->count] = udata;
+    p->count++;
+    return 0;
+}
+
+int net_poller_mod(NetPoller* p, NetSocket* s, int events, void* udata)
+{
+    if (!p || !s) return -1;
+    int i = poller_find(p, s->sock);
+    if (i < 0) return -1;
+
+    p->fds[i].events = to_poll_events(events);
+    p->udata[i] = udata;
+    return 0;
+}
+
+int net_poller_del(NetPoller* p, NetSocket* s)
+{
+    if (!p || !s) return -1;
+    int i = poller_find(p, s->sock);
+    if (i < 0) return -1;
+
+    p->count--;
+    p->fds[i] = p->fds[p->count];
+    p->udata[i] = p->udata[p->count];
+    return 0;
+}
+
+int net_poller_wait(NetPoller* p, NetPollEvent* events, int max_events, int timeout_ms)
+{
+    if (!p || !events || max_events <= 0) return -1;
+
+    int n = WSAPoll(p->fds, (ULONG)p->count, timeout_ms);
+    if (n == SOCKET_ERROR) return -1;
+
+    if (p->fds[0].revents) {
+        char drain[64];
+        while (recv(p->wake, drain, sizeof(drain), 0) > 0) {}
+    }
+
+    int out = 0;
+    for (int i = 1; i < p->count && out < max_events; i++) {
+        SHORT ev = p->fds[i].revents;
+        if (!ev) continue;
+
+        events[out].udata = p->udata[i];
+        events[out].events = 0;
+        if (ev & POLLRDNORM) events[out].events |= NET_POLL_READ;
+        if (ev & POLLWRNORM) events[out].events |= NET_POLL_WRITE;
+        if (ev & (POLLERR | POLLHUP | POLLNVAL)) events[out].events |= NET_POLL_ERROR;
+        out++;
+    }
+    return out;
+}
+
+void net_poller_wakeup(NetPoller* p)
+{
+    if (!p) return;
+    char c = 1;
+    send(p->wake, &c, 1, 0);
+}
+
+void net_poller_free(NetPoller* p)
+{
+    if (!p) return;
+    closesocket(p->wake);
+    free(p->fds);
+    free(p->udata);
+    free(p);
+}
+
 // ======== 綫程 ========
 struct Thread
 {
@@ -189,6 +389,19 @@ void thread_free(Thread* t)
     free(t);
 }
 
+int thread_set_affinity(Thread* t, int cpu)
+{
+    if (!t || cpu < 0 || cpu >= (int)(sizeof(DWORD_PTR) * 8)) return -1;
+    return SetThreadAffinityMask(t->handle, (DWORD_PTR)1 << cpu) ? 0 : -1;
+}
+
+int cpu_count(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
 void thread_sleep(long ms)
 {
     if (ms <= 0) return;
@@ -259,7 +472,117 @@ int mkdirectory(const char* path)
     return -1;
 }
 
+struct FileHandle
+{
+    HANDLE handle;
+};
+
+FileHandle* file_open_read(const char* path, uint64_t* size)
+{
+    if (!path) return NULL;
+
+    HANDLE h = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE) return NULL;
+
+    LARGE_INTEGER sz;
+    if (GetFileType(h) != FILE_TYPE_DISK || !GetFileSizeEx(h, &sz)) {
+        CloseHandle(h);
+        return NULL;
+    }
+
+    FileHandle* f = (FileHandle*)malloc(sizeof(FileHandle));
+    if (!f) {
+        CloseHandle(h);
+        return NULL;
+    }
+    f->handle = h;
+    if (size) *size = (uint64_t)sz.QuadPart;
+    return f;
+}
+
+void file_close(FileHandle* f)
+{
+    if (!f) return;
+    CloseHandle(f->handle);
+    free(f);
+}
+
+int64_t file_read(FileHandle* f, void* buf, size_t len, uint64_t offset)
+{
+    if (!f) return -1;
+    if (len > 0x7fffffff) len = 0x7fffffff;
+
+    OVERLAPPED ov = {0};
+    ov.Offset = (DWORD)(offset & 0xFFFFFFFF);
+    ov.OffsetHigh = (DWORD)(offset >> 32);
+
+    DWORD r = 0;
+    if (!ReadFile(f->handle, buf, (DWORD)len, &r, &ov))
+        return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+    return (int64_t)r;
+}
+
+// FILETIME 以 1601 年起的 100 納秒為單位
+static int64_t filetime_to_ns(FILETIME ft)
+{
+    uint64_t t = ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    return ((int64_t)t - 116444736000000000LL) * 100;
+}
+
+int file_fstat(FileHandle* f, uint64_t* size, int64_t* mtime_ns)
+{
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!f || !GetFileInformationByHandle(f->handle, &info)) return -1;
+    if (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) return -1;
+
+    if (size) *size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    if (mtime_ns) *mtime_ns = filetime_to_ns(info.ftLastWriteTime);
+    return 0;
+}
+
+int file_stat(const char* path, uint64_t* size, int64_t* mtime_ns)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!path || !GetFileAttributesExA(path, GetFileExInfoStandard, &data)) return -1;
+    if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) return -1;
+
+    if (size) *size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    if (mtime_ns) *mtime_ns = filetime_to_ns(data.ftLastWriteTime);
+    return 0;
+}
+
+// 暫不支持，文件緩存改為按修改時間檢查
+FileWatcher* file_watcher_create(void) { return NULL; }
+int file_watcher_add(FileWatcher* w, const char* path) { (void)w; (void)path; return -1; }
+void file_watcher_remove(FileWatcher* w, int id) { (void)w; (void)id; }
+int file_watcher_wait(FileWatcher* w, int* ids, int max, int timeout_ms) { (void)w; (void)ids; (void)max; (void)timeout_ms; return -1; }
+void file_watcher_free(FileWatcher* w) { (void)w; }
+
+// Windows 沒有 sendfile，退化為按偏移讀取後 send
+int64_t net_sendfile(NetSocket* s, FileHandle* f, uint64_t offset, size_t count)
+{
+    if (!s || !f) return -1;
+
+    char buf[64 * 1024];
+    if (count > sizeof(buf)) count = sizeof(buf);
+
+    OVERLAPPED ov = {0};
+    ov.Offset = (DWORD)(offset & 0xFFFFFFFF);
+    ov.OffsetHigh = (DWORD)(offset >> 32);
+
+    DWORD r = 0;
+    if (!ReadFile(f->handle, buf, (DWORD)count, &r, &ov)) return -1;
+    if (r == 0) return 0;
+    return net_send(s, buf, (int)r);
+}
+
 int localtime_safe(const time_t* t, struct tm* out_tm)
 {
     return localtime_s(out_tm, t);
+}
+
+uint64_t time_now_ms(void)
+{
+    return (uint64_t)GetTickCount64();
 }
\ No newline at end of file
@@ -61,16 +61,11 @@ int main(void)
     register_put_route("/test_put", test_put);
     register_delete_route("/test_delete", test_delete);
 
-    while (1) {
-        NetSocket* client = net_accept(server);
-        if (!client) continue;
+    // 長連接：每個連接最多 100 個請求，空閒 5 秒關閉
+    http_server_set_keep_alive(100, 5000);
 
-        ClientTaskArg* arg = malloc(sizeof(ClientTaskArg));
-        arg->s = server;
-        arg->client = client;
-
-        thread_pool_submit(pool, handle_client_task, arg);
-    }
+    // 事件循環：只有收到完整請求後才交給線程池
+    http_server_run(server, pool);
 
     net_shutdown();
     log_shutdown();
@@ -0,0 +1,56 @@
+// 文件緩存測試：大量探測不存在的路徑時，不存在的記錄不能擠掉緩存中的熱點文件
+#include "http/http.h"
+#include "http/http_file_cache_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define PROBES 20000
+
+static int test_missing_keeps_hot_file(const char* dir) {
+    char hot_path[256];
+    snprintf(hot_path, sizeof(hot_path), "%s/app.js", dir);
+    FILE* f = fopen(hot_path, "w");
+    if (!f) return 1;
+    fputs("console.log(1);", f);
+    fclose(f);
+
+    // 每個分片只有最低預算，不存在的記錄若計入預算，很快就會淘汰熱點文件
+    http_server_set_file_cache(HTTP_FILE_CACHE_MIN_SHARD_BYTES, 4096);
+    const HttpCachedFile* hot = http_file_cache_get(hot_path, NULL);
+    if (!hot) {
+        printf("FAIL missing entries: hot file not cached\n");
+        unlink(hot_path);
+        return 1;
+    }
+
+    int recorded = 0;
+    for (int i = 0; i < PROBES; i++) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/random%d.js.gz", dir, i);
+        int missing = 0;
+        const HttpCachedFile* e = http_file_cache_get(path, &missing);
+        http_file_cache_release(e);
+        if (missing) recorded++;
+    }
+
+    // 仍持有 hot 的引用，地址不會被重用：命中時返回同一條目
+    const HttpCachedFile* again = http_file_cache_get(hot_path, NULL);
+    int failed = again != hot || recorded != PROBES;
+    printf(failed ? "FAIL missing entries evicted the hot file\n" : "ok   missing entries\n");
+
+    http_file_cache_release(again);
+    http_file_cache_release(hot);
+    unlink(hot_path);
+    return failed;
+}
+
+int main(void) {
+    char dir[] = "/tmp/cweb_cache_XXXXXX";
+    if (!mkdtemp(dir)) return 1;
+    int failed = test_missing_keeps_hot_file(dir);
+    rmdir(dir);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,252 @@
+// 事件循環的超時測試：逐字節慢速發送請求頭的連接必須在請求頭總時限內被關閉；
+// 流式響應的 producer 暫時沒有數據時不能被反覆空轉調用；靜態目錄不發送隱藏文件
+#include "utils/platform/platform.h"
+#include "utils/log/logger.h"
+#include "http/http.h"
+#include "http/http_request.h"
+#include "http/http_response.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TEST_PORT 18931
+#define HEADER_TIMEOUT_MS 800
+#define TRICKLE_MS 300
+#define STREAM_WAIT_MS 500
+
+static void hello(const HttpRequest* req, HttpResponse* res) {
+    (void)req;
+    http_response_status_ok(res);
+    http_response_set_text(res, "hello");
+}
+
+static atomic_int g_producer_calls;
+
+// 前 STREAM_WAIT_MS 毫秒沒有數據，之後一次寫完並結束
+static void slow_producer(HttpResponse* res, void* ctx) {
+    uint64_t* start = ctx;
+    if (!res) {
+        free(start);
+        return;
+    }
+    atomic_fetch_add(&g_producer_calls, 1);
+    if (time_now_ms() - *start < STREAM_WAIT_MS) return;
+    http_response_write_chunk(res, "late", 4);
+    http_response_end(res);
+}
+
+static void slow_stream(const HttpRequest* req, HttpResponse* res) {
+    (void)req;
+    uint64_t* start = malloc(sizeof(uint64_t));
+    if (!start) {
+        http_response_status_error(res);
+        return;
+    }
+    *start = time_now_ms();
+    http_response_status_ok(res);
+    http_response_begin_stream(res, slow_producer, start);
+}
+
+static void run_server(void* arg) {
+    http_server_run((NetSocket*)arg, NULL);
+}
+
+static int connect_local(void) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(TEST_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (int i = 0; i < 50; i++) {
+        if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0) return fd;
+        thread_sleep(20);
+    }
+    close(fd);
+    return -1;
+}
+
+// 服務器關閉連接（讀到 EOF 或出錯）時返回 1；之前收到的錯誤響應一併讀掉
+static int peer_closed(int fd, int wait_ms) {
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    while (poll(&pfd, 1, wait_ms) > 0) {
+        char buf[512];
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) return 1;
+    }
+    return 0;
+}
+
+// 請求頭每次只發一個字節，間隔短於空閒超時；連接應在請求頭時限附近被關閉，而不是一直保持
+static int test_header_trickle(void) {
+    int fd = connect_local();
+    if (fd < 0) {
+        printf("FAIL header trickle: cannot connect\n");
+        return 1;
+    }
+
+    const char* head = "GET /hello HTTP/1.1\r\nHost: localhost\r\nX-Slow: aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\r\n\r\n";
+    uint64_t start = time_now_ms();
+    int closed = 0;
+    for (const char* p = head; *p && !closed; p++) {
+        if (send(fd, p, 1, MSG_NOSIGNAL) != 1) {
+            closed = 1;
+            break;
+        }
+        closed = peer_closed(fd, TRICKLE_MS);
+    }
+    uint64_t elapsed = time_now_ms() - start;
+    close(fd);
+
+    // 時間輪的精度和發送間隔留出餘量
+    if (!closed || elapsed > HEADER_TIMEOUT_MS + 2 * TRICKLE_MS + 500) {
+        printf("FAIL header trickle: closed=%d after %llu ms, header timeout %d ms\n",
+               closed, (unsigned long long)elapsed, HEADER_TIMEOUT_MS);
+        return 1;
+    }
+    printf("ok   header trickle closed after %llu ms\n", (unsigned long long)elapsed);
+    return 0;
+}
+
+// 發送一個 Connection: close 的 GET 請求，把響應讀到 buf 中；連接失敗時返回 -1
+static int fetch(const char* path, char* buf, size_t cap) {
+    int fd = connect_local();
+    if (fd < 0) return -1;
+    char req[256];
+    int n = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n", path);
+    send(fd, req, (size_t)n, MSG_NOSIGNAL);
+
+    size_t len = 0;
+    ssize_t r;
+    while (len < cap - 1 && (r = recv(fd, buf + len, cap - 1 - len, 0)) > 0) len += (size_t)r;
+    buf[len] = '\0';
+    close(fd);
+    return 0;
+}
+
+// 對照：請求頭一次發完時正常響應
+static int test_normal_request(void) {
+    char buf[1024];
+    if (fetch("/hello", buf, sizeof(buf)) != 0) {
+        printf("FAIL normal request: cannot connect\n");
+        return 1;
+    }
+    if (strncmp(buf, "HTTP/1.1 200", 12) != 0 || !strstr(buf, "hello")) {
+        printf("FAIL normal request: %s\n", buf);
+        return 1;
+    }
+    printf("ok   normal request\n");
+    return 0;
+}
+
+// producer 沒有數據時應隔一段時間再調用；空轉時等待期間會被調用成千上萬次
+static int test_idle_producer(void) {
+    char buf[1024];
+    if (fetch("/slow", buf, sizeof(buf)) != 0) {
+        printf("FAIL idle producer: cannot connect\n");
+        return 1;
+    }
+
+    int calls = atomic_load(&g_producer_calls);
+    int limit = STREAM_WAIT_MS / HTTP_STREAM_RETRY_MS * 3 + 5;
+    if (strncmp(buf, "HTTP/1.1 200", 12) != 0 || !strstr(buf, "late") || calls > limit) {
+        printf("FAIL idle producer: called %d times (limit %d), response: %s\n", calls, limit, buf);
+        return 1;
+    }
+    printf("ok   idle producer called %d times\n", calls);
+    return 0;
+}
+
+// 以 '.' 開頭的文件和目錄（.env、.git）不能經由靜態目錄讀到
+static int test_static_dotfiles(void) {
+    static const struct {
+        const char* url;
+        int ok;
+    } cases[] = {
+        { "/static/ok.txt", 1 },
+        { "/static/./ok.txt", 1 },
+        { "/static/.env", 0 },
+        { "/static/.git/config", 0 },
+        { "/static/.git/../ok.txt", 0 },
+    };
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        char buf[1024];
+        if (fetch(cases[i].url, buf, sizeof(buf)) != 0) {
+            printf("FAIL static dotfiles: cannot connect\n");
+            return 1;
+        }
+        int served = strncmp(buf, "HTTP/1.1 200", 12) == 0 && strstr(buf, "visible");
+        int hidden = strncmp(buf, "HTTP/1.1 404", 12) == 0 && !strstr(buf, "secret");
+        if (cases[i].ok ? !served : !hidden) {
+            printf("FAIL static dotfiles: %s\n%s\n", cases[i].url, buf);
+            failed = 1;
+        }
+    }
+    if (!failed) printf("ok   static dotfiles\n");
+    return failed;
+}
+
+static int write_file(const char* dir, const char* name, const char* text) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+    fputs(text, f);
+    fclose(f);
+    return 0;
+}
+
+int main(void) {
+    log_init(LOG_FATAL, 0, "");
+    net_init();
+
+    http_server_set_timeouts(HEADER_TIMEOUT_MS, 5000, 5000);
+    http_server_set_keep_alive(100, 10000);
+    register_get_route("/hello", hello);
+    register_get_route("/slow", slow_stream);
+
+    char dir[] = "/tmp/cweb_static_XXXXXX";
+    char git_dir[64];
+    if (!mkdtemp(dir)) return 1;
+    snprintf(git_dir, sizeof(git_dir), "%s/.git", dir);
+    if (mkdir(git_dir, 0700) != 0 || write_file(dir, "ok.txt", "visible") != 0 ||
+        write_file(dir, ".env", "secret") != 0 || write_file(dir, ".git/config", "secret") != 0) {
+        printf("FAIL cannot create static directory\n");
+        return 1;
+    }
+    register_static_dir("/static", dir);
+
+    NetSocket* server = net_tcp_listen("127.0.0.1", TEST_PORT);
+    if (!server) {
+        printf("FAIL cannot listen on %d\n", TEST_PORT);
+        return 1;
+    }
+    Thread* t = thread_create(run_server, server);
+    if (!t) return 1;
+    thread_detach(t);
+
+    int failed = 0;
+    failed += test_normal_request();
+    failed += test_header_trickle();
+    failed += test_idle_producer();
+    failed += test_static_dotfiles();
+
+    char path[96];
+    static const char* const names[] = { "ok.txt", ".env", ".git/config", ".git" };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+        remove(path);
+    }
+    rmdir(dir);
+    return failed ? 1 : 0;
+}
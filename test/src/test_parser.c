@@ -0,0 +1,188 @@
+// 請求解析測試：請求體長度有歧義（可能導致請求走私）的請求頭和 chunk 行必須被拒絕；
+// 流水綫上的多個請求和響應應全部放進連接 arena 的第一個塊，不再單獨分配
+#include "http/http_arena_internal.h"
+#include "http/http_paser_internal.h"
+#include "http/http_response_internal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+typedef struct BodyCase {
+    const char* headers;        // 請求行之後、空行之前的頭部
+    int ok;                     // http_body_decoder_init 是否應接受
+    int chunked;
+    unsigned long long length;
+} BodyCase;
+
+static const BodyCase g_body_cases[] = {
+    { "", 1, 0, 0 },
+    { "Content-Length: 5\r\n", 1, 0, 5 },
+    { "Content-Length: 5\r\nContent-Length: 5\r\n", 1, 0, 5 },
+    { "Content-Length: 5\r\nContent-Length: 100\r\n", 0, 0, 0 },
+    { "Content-Length: 100\r\nX-A: b\r\ncontent-length: 5\r\n", 0, 0, 0 },
+    { "Content-Length: 5, 5\r\n", 0, 0, 0 },
+    { "Content-Length: 5,100\r\n", 0, 0, 0 },
+    { "Content-Length: +5\r\n", 0, 0, 0 },
+    { "Content-Length: 0x10\r\n", 0, 0, 0 },
+    { "Content-Length: \r\n", 0, 0, 0 },
+    { "Content-Length: 99999999999999999999999\r\n", 0, 0, 0 },
+    { "Transfer-Encoding: chunked\r\n", 1, 1, 0 },
+    { "Transfer-Encoding: CHUNKED\r\n", 1, 1, 0 },
+    { "Transfer-Encoding: gzip, chunked\r\n", 1, 1, 0 },
+    { "Transfer-Encoding: gzip\r\nTransfer-Encoding: chunked\r\n", 1, 1, 0 },
+    { "Transfer-Encoding: chunked, gzip\r\n", 0, 0, 0 },
+    { "Transfer-Encoding: chunked\r\nTransfer-Encoding: gzip\r\n", 0, 0, 0 },
+    { "Transfer-Encoding: chunked, chunked\r\n", 0, 0, 0 },
+    { "Transfer-Encoding: gzip\r\n", 0, 0, 0 },
+    { "Transfer-Encoding: chunked\r\nContent-Length: 5\r\n", 0, 0, 0 },
+    { "Content-Length: 5\r\nTransfer-Encoding: chunked\r\n", 0, 0, 0 },
+};
+
+static int test_body_framing(void) {
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(g_body_cases) / sizeof(g_body_cases[0]); i++) {
+        const BodyCase* c = &g_body_cases[i];
+        char head[512];
+        int len = snprintf(head, sizeof(head), "POST /x HTTP/1.1\r\nHost: a\r\n%s\r\n", c->headers);
+
+        HttpArena arena;
+        http_arena_init(&arena);
+        HttpHeadParser p;
+        http_head_parser_init(&p, 8192, 64);
+
+        size_t consumed;
+        HttpRequest* req;
+        int r = http_head_parser_feed(&p, head, (size_t)len, &consumed, &arena, &req);
+        HttpBodyDecoder d;
+        int ok = r == 1 && http_body_decoder_init(&d, req) == 0;
+        int match = r == 1 && ok == c->ok &&
+                    (!ok || (d.chunked == c->chunked && d.content_length == c->length));
+        if (!match) {
+            printf("FAIL body framing: %s", c->headers[0] ? c->headers : "(no body headers)\n");
+            failed = 1;
+        }
+
+        http_head_parser_free(&p);
+        http_arena_free(&arena);
+    }
+    if (!failed) printf("ok   body framing\n");
+    return failed;
+}
+
+typedef struct ChunkCase {
+    const char* body;
+    int result;                 // http_body_decode 的返回值
+    const char* decoded;        // 結束時解碼出的內容
+} ChunkCase;
+
+static const ChunkCase g_chunk_cases[] = {
+    { "5\r\nhello\r\n0\r\n\r\n", 1, "hello" },
+    { "5;ext=1\r\nhello\r\n6\r\n world\r\n0\r\nX-Trailer: v\r\n\r\n", 1, "hello world" },
+    { "5\nhello\r\n0\r\n\r\n", -1, NULL },
+    { "5\r\nhello\n0\r\n\r\n", -1, NULL },
+    { "5\r\nhello\r\n0\n\r\n", -1, NULL },
+    { "5\r\nhello\r\n0\r\n\n", -1, NULL },
+    { "5\r\nhello\r\n0\r\nX-Trailer: v\n\r\n", -1, NULL },
+    { "5;a\rb\r\nhello\r\n0\r\n\r\n", -1, NULL },
+};
+
+typedef struct DecodeBuf {
+    char data[64];
+    size_t len;
+} DecodeBuf;
+
+static int collect(void* ctx, const char* data, size_t len) {
+    DecodeBuf* b = ctx;
+    if (b->len + len >= sizeof(b->data)) return -1;
+    memcpy(b->data + b->len, data, len);
+    b->len += len;
+    return 0;
+}
+
+static int test_chunk_lines(void) {
+    static const char head[] = "POST /x HTTP/1.1\r\nHost: a\r\nTransfer-Encoding: chunked\r\n\r\n";
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(g_chunk_cases) / sizeof(g_chunk_cases[0]); i++) {
+        const ChunkCase* c = &g_chunk_cases[i];
+        HttpArena arena;
+        http_arena_init(&arena);
+        HttpHeadParser p;
+        http_head_parser_init(&p, 8192, 64);
+
+        size_t consumed;
+        HttpRequest* req;
+        HttpBodyDecoder d;
+        DecodeBuf out = { { 0 }, 0 };
+        int r = -3;
+        if (http_head_parser_feed(&p, head, sizeof(head) - 1, &consumed, &arena, &req) == 1 &&
+            http_body_decoder_init(&d, req) == 0)
+            r = http_body_decode(&d, c->body, strlen(c->body), &consumed, collect, &out);
+
+        if (r != c->result || (c->decoded && (out.len != strlen(c->decoded) ||
+                                              memcmp(out.data, c->decoded, out.len) != 0))) {
+            printf("FAIL chunk lines: case %zu returned %d\n", i, r);
+            failed = 1;
+        }
+
+        http_head_parser_free(&p);
+        http_arena_free(&arena);
+    }
+    if (!failed) printf("ok   chunk lines\n");
+    return failed;
+}
+
+// 塊頭只有幾個字段，上界留出少量餘量
+static int in_first_block(const HttpArena* a, const void* p, size_t size) {
+    const char* block = (const char*)a->keep;
+    const char* s = (const char*)p;
+    return block && s > block && s + size <= block + HTTP_ARENA_BLOCK_SIZE + 64;
+}
+
+static int test_pipelined_arena(void) {
+    static const char head[] =
+        "GET /assets/app.js?v=1 HTTP/1.1\r\n"
+        "Host: example.com\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko)\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+        "Accept-Encoding: gzip, deflate, br\r\n"
+        "Cookie: session=0123456789abcdef0123456789abcdef\r\n"
+        "\r\n";
+
+    HttpArena arena;
+    http_arena_init(&arena);
+    HttpHeadParser p;
+    http_head_parser_init(&p, 8192, 64);
+
+    int failed = 0;
+    for (int i = 0; i < 4 && !failed; i++) {
+        size_t consumed;
+        HttpRequest* req;
+        HttpResponse* res;
+        if (http_head_parser_feed(&p, head, sizeof(head) - 1, &consumed, &arena, &req) != 1 ||
+            !(res = http_response_create(&arena))) {
+            failed = 1;
+            break;
+        }
+        http_response_add_header(res, "Content-Type", "application/javascript");
+        http_response_add_header(res, "Cache-Control", "public, max-age=31536000, immutable");
+        http_response_add_header(res, "ETag", "\"18df83a103319f3d-16e360\"");
+        // 大塊單獨分配時 head 不變，這裡直接看請求和響應是否落在第一個塊中
+        if (arena.head != arena.keep || !in_first_block(&arena, req, sizeof(HttpRequest)) ||
+            !in_first_block(&arena, res, sizeof(HttpResponse)))
+            failed = 1;
+    }
+    printf(failed ? "FAIL pipelined requests spilled out of the first arena block\n"
+                  : "ok   pipelined arena\n");
+
+    http_head_parser_free(&p);
+    http_arena_free(&arena);
+    return failed;
+}
+
+int main(void) {
+    int failed = 0;
+    failed += test_body_framing();
+    failed += test_chunk_lines();
+    failed += test_pipelined_arena();
+    return failed ? 1 : 0;
+}
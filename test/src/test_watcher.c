@@ -0,0 +1,74 @@
+// 文件監視測試：一次變化的文件比調用方一次能接收的事件多時，剩下的事件留到下次返回，不能丟棄
+#include "utils/platform/platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FILE_COUNT 200
+#define BATCH 16
+
+static int test_no_lost_events(const char* dir) {
+    FileWatcher* w = file_watcher_create();
+    if (!w) {
+        printf("skip no lost events: file watching not supported\n");
+        return 0;
+    }
+
+    static char paths[FILE_COUNT][256];
+    static int wds[FILE_COUNT];
+    static int seen[FILE_COUNT];
+    for (int i = 0; i < FILE_COUNT; i++) {
+        snprintf(paths[i], sizeof(paths[i]), "%s/f%d.txt", dir, i);
+        FILE* f = fopen(paths[i], "w");
+        if (!f) return 1;
+        fputs("old", f);
+        fclose(f);
+        wds[i] = file_watcher_add(w, paths[i]);
+        if (wds[i] < 0) return 1;
+    }
+
+    // 全部修改完再讀取，事件一次積壓在內核隊列中
+    for (int i = 0; i < FILE_COUNT; i++) {
+        FILE* f = fopen(paths[i], "w");
+        if (!f) return 1;
+        fputs("new", f);
+        fclose(f);
+    }
+
+    int ids[BATCH];
+    int n;
+    int overflow = 0;
+    while ((n = file_watcher_wait(w, ids, BATCH, 200)) > 0) {
+        for (int k = 0; k < n; k++) {
+            if (ids[k] == FILE_WATCH_OVERFLOW) overflow = 1;
+            for (int i = 0; i < FILE_COUNT; i++) {
+                if (wds[i] == ids[k]) seen[i] = 1;
+            }
+        }
+    }
+
+    int missed = 0;
+    for (int i = 0; i < FILE_COUNT; i++) {
+        if (!seen[i]) missed++;
+        unlink(paths[i]);
+    }
+    file_watcher_free(w);
+
+    // 隊列溢出時調用方會把所有監視當作失效，同樣不會漏掉變化
+    if (missed && !overflow) {
+        printf("FAIL no lost events: %d of %d changed files not reported\n", missed, FILE_COUNT);
+        return 1;
+    }
+    printf("ok   no lost events\n");
+    return 0;
+}
+
+int main(void) {
+    char dir[] = "/tmp/cweb_watch_XXXXXX";
+    if (!mkdtemp(dir)) return 1;
+    int failed = test_no_lost_events(dir);
+    rmdir(dir);
+    return failed ? 1 : 0;
+}